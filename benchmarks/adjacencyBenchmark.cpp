@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include "meshAdjacency.h"
+#include "testMeshes.h"
+
+//Compares adjacency reconstruction before the hash tables (std::map of positions
+//and of edges) with WeldPositions + BuildEdges, for meshes with split vertices
+//(three per face, as with per-face normals).
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	vector<Edge> LegacyAdjacency(const vector<XMFLOAT3>& vertices, const vector<Face>& faces, vector<XMFLOAT3>& positions)
+	{
+		map<tuple<float, float, float>, unsigned> positionIndex;
+		vector<unsigned> vertexPositions(vertices.size());
+		positions.clear();
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			auto [it, inserted] = positionIndex.emplace(make_tuple(vertices[i].x, vertices[i].y, vertices[i].z),
+				static_cast<unsigned>(positions.size()));
+			if (inserted)
+				positions.push_back(vertices[i]);
+			vertexPositions[i] = it->second;
+		}
+		map<pair<unsigned, unsigned>, Edge> edgeMap;
+		for (unsigned f = 0; f < faces.size(); ++f)
+			for (int i = 0; i < 3; ++i)
+			{
+				auto key = minmax(vertexPositions[faces[f].indices[i]], vertexPositions[faces[f].indices[(i + 1) % 3]]);
+				auto it = edgeMap.find(key);
+				if (it == edgeMap.end())
+					edgeMap[key] = Edge(key.first, key.second, f, UINT_MAX);
+				else if (it->second.face1 == UINT_MAX)
+					it->second.face1 = f;
+			}
+		vector<Edge> edges;
+		edges.reserve(edgeMap.size());
+		for (const auto& [_, edge] : edgeMap)
+			edges.push_back(edge);
+		return edges;
+	}
+
+	template<typename F>
+	double MeasureMs(F&& f, int repeats)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+			f();
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+	}
+}
+
+int main()
+{
+	const struct { unsigned rings, sides; } sizes[] = { { 20, 25 }, { 100, 50 }, { 250, 200 }, { 1000, 500 } };
+	printf("%10s %10s %12s %12s %8s %14s\n", "triangles", "edges", "legacy ms", "hash ms", "speedup", "hash ns/face");
+	for (auto size : sizes)
+	{
+		auto torus = test::Torus(size.rings, size.sides);
+		vector<XMFLOAT3> vertices;
+		vector<Face> faces;
+		vertices.reserve(3 * torus.faces.size());
+		for (const Face& face : torus.faces)
+		{
+			auto first = static_cast<unsigned>(vertices.size());
+			for (unsigned index : face.indices)
+				vertices.push_back(torus.vertices[index]);
+			faces.emplace_back(first, first + 1, first + 2);
+		}
+
+		int repeats = max(1, static_cast<int>(2000000 / faces.size()));
+		vector<XMFLOAT3> positions;
+		size_t legacyEdges = 0, edges = 0;
+		double legacy = MeasureMs([&] { legacyEdges = LegacyAdjacency(vertices, faces, positions).size(); }, repeats);
+		double hashed = MeasureMs([&]
+		{
+			WeldedPositions welded = WeldPositions(vertices);
+			edges = BuildEdges(faces, welded.vertexPositions).size();
+		}, repeats);
+		if (edges != legacyEdges)
+			printf("edge count mismatch: %zu vs %zu\n", edges, legacyEdges);
+		printf("%10zu %10zu %12.3f %12.3f %7.1fx %14.1f\n", faces.size(), edges, legacy, hashed, legacy / hashed,
+			1e6 * hashed / faces.size());
+	}
+	return 0;
+}
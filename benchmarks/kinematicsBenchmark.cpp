@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "pumaKinematics.h"
+
+//Forward and inverse kinematics throughput: configurations (targets) per second one at a time
+//and with the structure-of-arrays batch kernels, and the iterative solver warm started near the solution.
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	template<typename F>
+	double MeasureMs(F&& f, int repeats)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+			f();
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+	}
+}
+
+int main()
+{
+	PumaKinematics kinematics;
+	mt19937 rng(1);
+	uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+	printf("%12s %14s %14s %14s %14s %14s %14s %10s\n", "configs", "FK single M/s", "FK batch M/s", "IK single M/s",
+		"IK batch M/s", "nearest M/s", "DLS M/s", "DLS iter");
+	for (size_t count : { 1000u, 100000u, 1000000u })
+	{
+		JointBatch angles;
+		angles.resize(count);
+		for (auto& a : angles.angles)
+			for (size_t i = 0; i < count; ++i)
+				a[i] = angle(rng);
+		ToolBatch tools;
+		tools.resize(count);
+		const int repeats = count < 100000 ? 200 : 5;
+		double singleMs = MeasureMs([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				float a[PumaJointCount];
+				for (size_t j = 0; j < PumaJointCount; ++j)
+					a[j] = angles.angles[j][i];
+				XMFLOAT3 p, n;
+				kinematics.ForwardKinematics(a, p, n);
+				tools.px[i] = p.x;
+			}
+		}, repeats);
+		double batchMs = MeasureMs([&] { kinematics.ForwardKinematics(angles, tools); }, repeats);
+
+		JointBatch solved;
+		solved.resize(count);
+		vector<uint8_t> reachable(solved.angles[0].size());
+		double singleIkMs = MeasureMs([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				float a[PumaJointCount];
+				reachable[i] = kinematics.InverseKinematics({ tools.px[i], tools.py[i], tools.pz[i] },
+					{ tools.nx[i], tools.ny[i], tools.nz[i] }, a);
+				solved.angles[0][i] = a[0];
+			}
+		}, repeats);
+		double batchIkMs = MeasureMs([&] { kinematics.InverseKinematics(tools, solved, reachable); }, repeats);
+		// wszystkie galezie i wybor najblizszej poprzedniemu celowi
+		double nearestMs = MeasureMs([&]
+		{
+			IkSolution solution = {};
+			for (size_t i = 0; i < count; ++i)
+			{
+				kinematics.NearestInverseKinematics({ tools.px[i], tools.py[i], tools.pz[i] },
+					{ tools.nx[i], tools.ny[i], tools.nz[i] }, solution.angles, solution);
+				solved.angles[0][i] = solution.angles[0];
+			}
+		}, repeats);
+		// DLS od konfiguracji przesunietej o 0.05 rad na kazdym przegubie, jak cel ruszony od poprzedniej klatki
+		DlsStats stats;
+		double dlsMs = MeasureMs([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				float a[PumaJointCount];
+				for (size_t j = 0; j < PumaJointCount; ++j)
+					a[j] = angles.angles[j][i] + 0.05f;
+				kinematics.DampedLeastSquares({ tools.px[i], tools.py[i], tools.pz[i] },
+					{ tools.nx[i], tools.ny[i], tools.nz[i] }, a, {}, &stats);
+				solved.angles[0][i] = a[0];
+			}
+		}, repeats);
+		printf("%12zu %14.2f %14.2f %14.2f %14.2f %14.2f %14.2f %10.2f\n", count, count / singleMs / 1e3, count / batchMs / 1e3,
+			count / singleIkMs / 1e3, count / batchIkMs / 1e3, count / nearestMs / 1e3, count / dlsMs / 1e3,
+			stats.AverageIterations());
+	}
+	return 0;
+}
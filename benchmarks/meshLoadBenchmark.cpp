@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include "meshFile.h"
+#include "testMeshes.h"
+
+//Compares loading the same mesh from the text formats with the former iostream loaders
+//and the from_chars parser, and from the binary format (memory-mapped, copied to
+//vectors or used as a view).
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	template<typename F>
+	double MeasureMs(F&& f, int repeats)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+			f();
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+	}
+
+	//Loaders before the from_chars parser
+	MeshData LegacyLoadTextMesh(const filesystem::path& path)
+	{
+		MeshData mesh;
+		ifstream input;
+		input.exceptions(ios::badbit | ios::failbit | ios::eofbit);
+		input.open(path);
+		unsigned n;
+		input >> n;
+		mesh.positions.resize(n);
+		for (auto& p : mesh.positions)
+			input >> p.x >> p.y >> p.z;
+		input >> n;
+		mesh.vertexPositions.resize(n);
+		mesh.normals.resize(n);
+		for (unsigned i = 0; i < n; ++i)
+			input >> mesh.vertexPositions[i] >> mesh.normals[i].x >> mesh.normals[i].y >> mesh.normals[i].z;
+		input >> n;
+		mesh.faces.resize(n);
+		for (auto& f : mesh.faces)
+			input >> f.indices[0] >> f.indices[1] >> f.indices[2];
+		input >> n;
+		mesh.edges.resize(n);
+		for (auto& e : mesh.edges)
+			input >> e.v0 >> e.v1 >> e.face0 >> e.face1;
+		return mesh;
+	}
+
+	IndexedMeshData LegacyLoadIndexedTextMesh(const filesystem::path& path)
+	{
+		IndexedMeshData mesh;
+		ifstream input;
+		input.exceptions(ios::badbit | ios::failbit | ios::eofbit);
+		input.open(path);
+		unsigned vertexCount, indexCount;
+		input >> vertexCount >> indexCount;
+		mesh.positions.resize(vertexCount);
+		mesh.normals.resize(vertexCount);
+		mesh.texCoords.resize(vertexCount);
+		for (unsigned i = 0; i < vertexCount; ++i)
+			input >> mesh.positions[i].x >> mesh.positions[i].y >> mesh.positions[i].z
+				>> mesh.normals[i].x >> mesh.normals[i].y >> mesh.normals[i].z >> mesh.texCoords[i].x >> mesh.texCoords[i].y;
+		mesh.indices.resize(indexCount);
+		for (auto& index : mesh.indices)
+			input >> index;
+		return mesh;
+	}
+
+	void SaveIndexedTextMesh(const MeshData& mesh, const filesystem::path& path)
+	{
+		ofstream output(path);
+		output << mesh.positions.size() << ' ' << 3 * mesh.faces.size() << '\n';
+		for (size_t i = 0; i < mesh.positions.size(); ++i)
+		{
+			const auto& p = mesh.positions[i];
+			const auto& n = mesh.normals[i];
+			output << p.x << ' ' << p.y << ' ' << p.z << ' ' << n.x << ' ' << n.y << ' ' << n.z << " 0.5 0.25\n";
+		}
+		for (const auto& f : mesh.faces)
+			output << f.indices[0] << ' ' << f.indices[1] << ' ' << f.indices[2] << '\n';
+	}
+
+	//Coordinates rounded to 4 decimal places, as in the resource meshes
+	MeshData ToMeshData(const ShadowCaster& caster)
+	{
+		auto round = [](XMFLOAT3 v)
+		{
+			return XMFLOAT3{ nearbyintf(v.x * 1e4f) / 1e4f, nearbyintf(v.y * 1e4f) / 1e4f, nearbyintf(v.z * 1e4f) / 1e4f };
+		};
+		MeshData mesh;
+		mesh.positions.resize(caster.positions.size());
+		transform(caster.positions.begin(), caster.positions.end(), mesh.positions.begin(), round);
+		mesh.vertexPositions.resize(caster.vertices.size());
+		mesh.normals.resize(caster.vertices.size());
+		for (uint32_t i = 0; i < caster.vertices.size(); ++i)
+		{
+			mesh.vertexPositions[i] = i;
+			XMFLOAT3 normal;
+			XMStoreFloat3(&normal, XMVector3Normalize(XMLoadFloat3(&caster.vertices[i])));
+			mesh.normals[i] = round(normal);
+		}
+		mesh.faces = caster.faces;
+		mesh.edges = caster.edges;
+		return mesh;
+	}
+}
+
+int main()
+{
+	// ostatni rozmiar - milion wierzcholkow
+	const struct { unsigned rings, sides; } sizes[] = { { 20, 25 }, { 100, 50 }, { 250, 200 }, { 1000, 1000 } };
+	auto text = filesystem::temp_directory_path() / "puma_benchmark.txt";
+	auto indexed = filesystem::temp_directory_path() / "puma_benchmark.mesh";
+	auto binary = filesystem::temp_directory_path() / (string("puma_benchmark") + BinaryMeshExtension);
+
+	printf("mesh*.txt format and binary\n%10s %10s %12s %12s %9s %12s %12s\n",
+		"vertices", "text MB", "stream ms", "parser ms", "speedup", "binary ms", "view ms");
+	for (auto size : sizes)
+	{
+		MeshData mesh = ToMeshData(test::Torus(size.rings, size.sides));
+		SaveTextMesh(MeshView(mesh), text);
+		SaveBinaryMesh(MeshView(mesh), binary);
+		const int repeats = static_cast<int>(max<size_t>(1, 200000 / mesh.faces.size()));
+
+		double streamMs = MeasureMs([&] { LegacyLoadTextMesh(text); }, repeats);
+		double parserMs = MeasureMs([&] { LoadTextMesh(text); }, repeats);
+		double binaryMs = MeasureMs([&] { LoadBinaryMesh(binary); }, repeats);
+		size_t edges = 0;
+		double viewMs = MeasureMs([&]
+		{
+			MappedFile file(binary);
+			edges += ViewBinaryMesh(file).edges.size;
+		}, repeats);
+		printf("%10zu %10.2f %12.3f %12.3f %8.1fx %12.3f %12.3f\n", mesh.positions.size(),
+			filesystem::file_size(text) / 1048576.0, streamMs, parserMs, streamMs / parserMs, binaryMs, viewMs);
+	}
+
+	printf("\n.mesh format\n%10s %10s %12s %12s %9s\n", "vertices", "text MB", "stream ms", "parser ms", "speedup");
+	for (auto size : sizes)
+	{
+		MeshData mesh = ToMeshData(test::Torus(size.rings, size.sides));
+		SaveIndexedTextMesh(mesh, indexed);
+		const int repeats = static_cast<int>(max<size_t>(1, 200000 / mesh.faces.size()));
+		double streamMs = MeasureMs([&] { LegacyLoadIndexedTextMesh(indexed); }, repeats);
+		double parserMs = MeasureMs([&] { LoadIndexedTextMesh(indexed); }, repeats);
+		printf("%10zu %10.2f %12.3f %12.3f %8.1fx\n", mesh.positions.size(),
+			filesystem::file_size(indexed) / 1048576.0, streamMs, parserMs, streamMs / parserMs);
+	}
+	filesystem::remove(text);
+	filesystem::remove(indexed);
+	filesystem::remove(binary);
+	return 0;
+}
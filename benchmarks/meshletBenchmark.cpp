@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include "meshlets.h"
+#include "meshFile.h"
+#include "testMeshes.h"
+
+//Fraction of meshlets skipped by silhouette extraction and back-face culling for a light
+//and a camera orbiting the mesh, and the time of the meshlet silhouette against a full scan
+//with the SIMD kernels. Tori of growing size and the manipulator meshes.
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	template<typename F>
+	double MeasureMs(F&& f, int repeats)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+			f();
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+	}
+
+	ShadowCaster Manipulator(int part)
+	{
+		const filesystem::path dir = PUMA_MESH_DIR;
+		MeshData data = LoadBinaryMesh(dir / ("mesh" + to_string(part) + BinaryMeshExtension));
+		ShadowCaster caster;
+		caster.positions = data.positions;
+		for (uint32_t p : data.vertexPositions)
+			caster.vertices.push_back(data.positions[p]);
+		caster.faces = data.faces;
+		caster.edges = data.edges;
+		CloseBoundaries(caster.faces, caster.edges);
+		caster.PrepareSilhouetteData();
+		return caster;
+	}
+
+	void Run(const char* name, ShadowCaster caster, float orbit)
+	{
+		FacePlanes planes;
+		EdgeFaces edgeFaces;
+		planes.Build(caster.vertices, caster.faces);
+		edgeFaces.Build(caster.edges);
+		caster.BuildMeshlets();
+		const auto& meshlets = caster.Meshlets();
+		FacePlanes clusteredPlanes;
+		EdgeFaces clusteredEdges;
+		clusteredPlanes.Build(caster.vertices, caster.faces);
+		clusteredEdges.Build(caster.edges);
+
+		// swiatlo i kamera okrazaja siatke co stopien, na dwoch wysokosciach
+		const int frames = 360;
+		auto orbitAt = [orbit](int frame, float height)
+		{
+			float t = XMConvertToRadians(static_cast<float>(frame));
+			return XMFLOAT3{ orbit * cosf(t), height, orbit * sinf(t) };
+		};
+		FaceBitset facing;
+		vector<uint32_t> silhouette;
+		vector<FaceRange> ranges;
+		double fullMs = MeasureMs([&]
+		{
+			for (int frame = 0; frame < frames; ++frame)
+			{
+				ClassifyFaces(planes, orbitAt(frame, 0.5f * orbit), false, facing);
+				GatherSilhouetteEdges(edgeFaces, facing, silhouette);
+			}
+		}, 1) / frames;
+		size_t skipped = 0, culled = 0;
+		double meshletMs = MeasureMs([&]
+		{
+			for (int frame = 0; frame < frames; ++frame)
+				skipped += GatherMeshletSilhouette(meshlets, clusteredPlanes, clusteredEdges, orbitAt(frame, 0.5f * orbit),
+					false, facing, silhouette);
+		}, 1) / frames;
+		for (int frame = 0; frame < frames; ++frame)
+			culled += VisibleMeshletFaces(meshlets, orbitAt(frame, 0.25f * orbit), ranges);
+		double total = static_cast<double>(frames) * meshlets.size();
+		printf("%12s %10zu %9zu %10.1f %9.1f%% %9.1f%% %10.4f %10.4f\n", name, caster.faces.size(), meshlets.size(),
+			static_cast<double>(caster.faces.size()) / meshlets.size(), 100.0 * skipped / total, 100.0 * culled / total,
+			fullMs, meshletMs);
+	}
+}
+
+int main()
+{
+	printf("%12s %10s %9s %10s %10s %10s %10s %10s\n", "mesh", "triangles", "meshlets", "faces/mlt",
+		"skipped", "culled", "full ms", "meshlet ms");
+	const struct { unsigned rings, sides; } sizes[] = { { 20, 25 }, { 100, 50 }, { 250, 200 }, { 1000, 500 } };
+	for (auto size : sizes)
+		Run(("torus " + to_string(size.rings) + "x" + to_string(size.sides)).c_str(), test::Torus(size.rings, size.sides), 3.0f);
+	for (int part = 1; part <= 6; ++part)
+		Run(("mesh" + to_string(part)).c_str(), Manipulator(part), 3.0f);
+	return 0;
+}
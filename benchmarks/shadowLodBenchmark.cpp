@@ -0,0 +1,57 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "testMeshes.h"
+
+//Levels of detail of shadow casters: faces, object-space error and shadow volume generation
+//time (silhouette extraction and emitted geometry) per level, with the time to build the chain.
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	template<typename F>
+	double MeasureMs(F&& f, int repeats)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+			f();
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+	}
+
+	void Run(const char* name, const ShadowCaster& caster)
+	{
+		ShadowLodChain lods;
+		double buildMs = MeasureMs([&] { lods.Build(caster); }, 1);
+		printf("%s: chain built in %.1f ms\n", name, buildMs);
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, XMMatrixIdentity());
+		ShadowVolume volume;
+		for (size_t level = 0; level < lods.Levels(); ++level)
+		{
+			const ShadowCaster& c = level ? lods.Level(level) : caster;
+			const int frames = 100;
+			double ms = MeasureMs([&]
+			{
+				for (int frame = 0; frame < frames; ++frame)
+				{
+					float t = XMConvertToRadians(3.6f * frame);
+					c.GenerateShadowVolume(volume, { 3.f * cosf(t), 2.f, 3.f * sinf(t) }, world, InfiniteExtrusion);
+				}
+			}, 1) / frames;
+			printf("%8zu %10zu %12.5f %10zu %10.4f\n", level, c.faces.size(), lods.Error(level), volume.indices.size() / 3, ms);
+		}
+	}
+}
+
+int main()
+{
+	printf("%8s %10s %12s %10s %10s\n", "level", "triangles", "error", "volume tri", "volume ms");
+	const struct { unsigned rings, sides; } sizes[] = { { 100, 50 }, { 250, 200 }, { 1000, 500 } };
+	for (auto size : sizes)
+		Run(("torus " + to_string(size.rings) + "x" + to_string(size.sides)).c_str(), test::Torus(size.rings, size.sides));
+	return 0;
+}
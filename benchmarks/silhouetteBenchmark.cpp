@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "testMeshes.h"
+
+//Compares silhouette extraction before the SoA kernels (per edge facing
+//tests on world-space vertices) with the kernels at each SIMD level,
+//and a full scan per frame with the temporal tracker for a light orbiting the mesh.
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	bool FacingFront(const vector<XMFLOAT3>& worldVertices, const Face& face, FXMVECTOR lightPos)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&worldVertices[face.indices[0]]);
+		XMVECTOR p1 = XMLoadFloat3(&worldVertices[face.indices[1]]);
+		XMVECTOR p2 = XMLoadFloat3(&worldVertices[face.indices[2]]);
+		XMVECTOR normal = XMVector3Normalize(XMVector3Cross(p1 - p0, p2 - p0));
+		return XMVectorGetX(XMVector3Dot(normal, XMVector3Normalize(p0 - lightPos))) > 0.f;
+	}
+
+	void LegacySilhouette(const ShadowCaster& caster, XMFLOAT3 light, const XMFLOAT4X4& world,
+		vector<XMFLOAT3>& worldVertices, vector<uint32_t>& silhouette)
+	{
+		XMMATRIX m = XMLoadFloat4x4(&world);
+		worldVertices.resize(caster.vertices.size());
+		for (size_t i = 0; i < caster.vertices.size(); ++i)
+			XMStoreFloat3(&worldVertices[i], XMVector3Transform(XMLoadFloat3(&caster.vertices[i]), m));
+		XMVECTOR l = XMLoadFloat3(&light);
+		silhouette.clear();
+		for (uint32_t i = 0; i < caster.edges.size(); ++i)
+		{
+			const Edge& edge = caster.edges[i];
+			if (edge.face1 == UINT_MAX)
+				continue;
+			if (FacingFront(worldVertices, caster.faces[edge.face0], l) != FacingFront(worldVertices, caster.faces[edge.face1], l))
+				silhouette.push_back(i);
+		}
+	}
+
+	template<typename F>
+	double MeasureMs(F&& f, int repeats)
+	{
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+			f();
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+	}
+
+	const char* Name(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::AVX2: return "avx2";
+		case SimdLevel::SSE4: return "sse4";
+		default: return "scalar";
+		}
+	}
+}
+
+int main()
+{
+	const struct { unsigned rings, sides; } sizes[] = { { 20, 25 }, { 100, 50 }, { 250, 200 }, { 1000, 500 } };
+	const XMFLOAT3 light{ 2.0f, 3.0f, 2.0f };
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixRotationY(0.3f) * XMMatrixTranslation(0.0f, 0.5f, 0.0f));
+	XMFLOAT3 objectLight;
+	XMStoreFloat3(&objectLight, XMVector3Transform(XMLoadFloat3(&light), XMMatrixInverse(nullptr, XMLoadFloat4x4(&world))));
+
+	vector<SimdLevel> levels{ SimdLevel::Scalar };
+	if (DetectSimdLevel() >= SimdLevel::SSE4)
+		levels.push_back(SimdLevel::SSE4);
+	if (DetectSimdLevel() >= SimdLevel::AVX2)
+		levels.push_back(SimdLevel::AVX2);
+
+	printf("%10s %10s %12s", "triangles", "edges", "legacy ms");
+	for (SimdLevel level : levels)
+		printf(" %10s ms", Name(level));
+	printf("\n");
+
+	for (auto size : sizes)
+	{
+		auto torus = test::Torus(size.rings, size.sides);
+		const int repeats = static_cast<int>(max<size_t>(1, 2000000 / torus.faces.size()));
+		vector<XMFLOAT3> worldVertices;
+		vector<uint32_t> silhouette;
+		printf("%10zu %10zu %12.4f", torus.faces.size(), torus.edges.size(),
+			MeasureMs([&] { LegacySilhouette(torus, light, world, worldVertices, silhouette); }, repeats));
+		const size_t expected = silhouette.size();
+
+		FacePlanes planes;
+		EdgeFaces edgeFaces;
+		planes.Build(torus.vertices, torus.faces);
+		edgeFaces.Build(torus.edges);
+		FaceBitset facing;
+		for (SimdLevel level : levels)
+		{
+			double ms = MeasureMs([&]
+			{
+				ClassifyFaces(planes, objectLight, false, facing, level);
+				GatherSilhouetteEdges(edgeFaces, facing, silhouette, level);
+			}, repeats);
+			printf(" %10.4f   ", ms);
+			// faces almost edge-on to the light may round differently than in the world-space test
+			if (silhouette.size() != expected)
+				fprintf(stderr, "%s: %zu silhouette edges, legacy %zu\n", Name(level), silhouette.size(), expected);
+		}
+		printf("\n");
+	}
+
+	printf("\n%10s %10s %12s %12s %10s\n", "triangles", "frames", "full ms", "tracker ms", "tested");
+	for (auto size : sizes)
+	{
+		auto torus = test::Torus(size.rings, size.sides);
+		FacePlanes planes;
+		EdgeFaces edgeFaces;
+		FaceEdges faceEdges;
+		planes.Build(torus.vertices, torus.faces);
+		edgeFaces.Build(torus.edges);
+		faceEdges.Build(torus.edges, torus.faces.size());
+		// light orbits half a degree per frame
+		const int frames = 360;
+		auto lightAt = [](int frame)
+		{
+			float t = XMConvertToRadians(0.5f * frame);
+			return XMFLOAT3{ 3.0f * cosf(t), 2.0f, 3.0f * sinf(t) };
+		};
+		FaceBitset facing;
+		vector<uint32_t> silhouette;
+		double fullMs = MeasureMs([&]
+		{
+			for (int frame = 0; frame < frames; ++frame)
+			{
+				ClassifyFaces(planes, lightAt(frame), false, facing);
+				GatherSilhouetteEdges(edgeFaces, facing, silhouette);
+			}
+		}, 1) / frames;
+		SilhouetteTracker tracker;
+		double tested = 0.0;
+		double trackerMs = MeasureMs([&]
+		{
+			for (int frame = 0; frame < frames; ++frame)
+			{
+				tracker.Update(planes, edgeFaces, faceEdges, lightAt(frame), {}, false, facing, silhouette);
+				tested += tracker.TestedFraction();
+			}
+		}, 1) / frames;
+		printf("%10zu %10d %12.4f %12.4f %9.1f%%\n", torus.faces.size(), frames, fullMs, trackerMs, 100.0 * tested / frames);
+	}
+	return 0;
+}
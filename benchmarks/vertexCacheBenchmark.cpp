@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include "testMeshes.h"
+#include "vertexCache.h"
+
+//Average cache miss ratio (ACMR) of the meshes before and after OptimizeVertexCache
+//for FIFO post-transform caches of 16 and 32 entries, and the optimizer time.
+
+using namespace mini;
+using namespace std;
+
+namespace
+{
+	void Report(const string& name, vector<uint32_t> indices, size_t vertexCount)
+	{
+		float before16 = SimulateAcmr(indices, vertexCount, 16), before32 = SimulateAcmr(indices, vertexCount, 32);
+		auto start = chrono::steady_clock::now();
+		OptimizeVertexCache(indices, vertexCount);
+		OptimizeVertexFetch(indices, vertexCount);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		printf("%-14s %10zu %8.3f %8.3f %8.3f %8.3f %10.3f\n", name.c_str(), indices.size() / 3, before16,
+			SimulateAcmr(indices, vertexCount, 16), before32, SimulateAcmr(indices, vertexCount, 32), ms);
+	}
+}
+
+int main()
+{
+	printf("%-14s %10s %8s %8s %8s %8s %10s\n", "mesh", "triangles", "fifo16", "opt16", "fifo32", "opt32", "opt ms");
+	const filesystem::path dir = PUMA_MESH_DIR;
+	for (int i = 1; i <= 6; ++i)
+	{
+		MeshData mesh = LoadBinaryMesh(dir / ("mesh" + to_string(i) + BinaryMeshExtension));
+		vector<uint32_t> indices;
+		for (const Face& face : mesh.faces)
+			indices.insert(indices.end(), begin(face.indices), end(face.indices));
+		Report("mesh" + to_string(i), indices, mesh.vertexPositions.size());
+	}
+	IndexedMeshData teapot = LoadIndexedTextMesh(dir / "teapot.mesh");
+	Report("teapot", teapot.indices, teapot.positions.size());
+
+	const struct { unsigned rings, sides; } sizes[] = { { 100, 50 }, { 1000, 500 } };
+	for (auto size : sizes)
+	{
+		auto torus = test::Torus(size.rings, size.sides);
+		vector<uint32_t> indices;
+		for (const Face& face : torus.faces)
+			indices.insert(indices.end(), begin(face.indices), end(face.indices));
+		Report("torus", indices, torus.vertices.size());
+	}
+	return 0;
+}
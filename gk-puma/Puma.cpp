@@ -1,7 +1,9 @@
 ﻿#include "Puma.h"
 #include <array>
+#include <cstring>
 #include <iostream>
 #include "mesh.h"
+#include "assetLoader.h"
 
 using namespace mini;
 using namespace gk2;
@@ -9,6 +11,21 @@ using namespace DirectX;
 using namespace std;
 const XMFLOAT4 Puma::LIGHT_POS = { 2.0f, 3.0f, 2.0f, 1.0f };
 
+namespace
+{
+	// rzutowanie perspektywiczne z plaszczyzna daleka w nieskonczonosci - bryly cienia
+	// wyciagane do punktow w = 0 nie sa obcinane; epsilon zostawia margines na bledy zaokraglen
+	XMMATRIX InfinitePerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ)
+	{
+		const float epsilon = 2.4e-7f;
+		XMFLOAT4X4 m;
+		XMStoreFloat4x4(&m, XMMatrixPerspectiveFovLH(fovAngleY, aspectRatio, nearZ, 2 * nearZ));
+		m._33 = 1.0f - epsilon;
+		m._43 = -nearZ * (1.0f - epsilon);
+		return XMLoadFloat4x4(&m);
+	}
+}
+
 Puma::Puma(HINSTANCE appInstance)
 	: DxApplication(appInstance, 1280, 720, L"Pokój"),
 	//Constant Buffers
@@ -18,14 +35,45 @@ Puma::Puma(HINSTANCE appInstance)
 	m_cbSurfaceColor(m_device.CreateConstantBuffer<XMFLOAT4>()),
 	m_cbLightPos(m_device.CreateConstantBuffer<XMFLOAT4, 2>()),
 	m_cbMirrorBuf(m_device.CreateConstantBuffer<XMFLOAT4, 2>()),
+	m_cbVertexDecode(m_device.CreateConstantBuffer<VertexDecode>()),
 	m_cbShadowControl(m_device.CreateConstantBuffer<XMINT4>()),
 	m_vbParticleSystem(m_device.CreateVertexBuffer<ParticleVertex>(ParticleSystem::MAX_PARTICLES)),
-	m_particleTexture(m_device.CreateShaderResourceView(L"resources/textures/particle.png"))
+	m_mirrorMtx(SceneMirrorMtx()), m_simulation(m_mirrorMtx)
 {
+	//Assets - files are read and parsed by the job system while the render states are created,
+	//Direct3D objects are created only on this thread
+	AssetLoader assets(m_jobs);
+	future<SMMesh> manipulator[6];
+	for (int i = 0; i < 6; i++)
+		manipulator[i] = assets.Load([i]
+		{
+			SMMesh mesh = SMMesh::LoadMesh(L"resources/meshes/mesh" + std::to_wstring(i + 1) + L".pmesh", true);
+			mesh.BuildShadowLods();
+			return mesh;
+		});
+	auto cylinder = assets.Load([]
+	{
+		SMMesh mesh = SMMesh::Cylinder(20, 20, 3.f, 0.5f);
+		mesh.BuildShadowLods();
+		return mesh;
+	});
+	auto mirror = assets.Load([] { return SMMesh::DoubleRect(1.5f, 1.f); });
+	const wchar_t* particleTexturePath = L"resources/textures/particle.png";
+	auto particleTexture = assets.Load([=] { return DxDevice::LoadByteCode(particleTexturePath); });
+	auto byteCode = [&assets](const wchar_t* file) { return assets.Load([file] { return DxDevice::LoadByteCode(file); }); };
+	auto phongVSCode = byteCode(L"phongVS.cso"), phongPSCode = byteCode(L"phongPS.cso");
+	auto phongVSMirrorCode = byteCode(L"phongVSMirror.cso"), phongPSMirrorCode = byteCode(L"phongPSMirror.cso");
+	auto texturedVSCode = byteCode(L"texturedVS.cso"), texturedPSCode = byteCode(L"texturedPS.cso");
+	auto colorTexPSCode = byteCode(L"colorTexPS.cso");
+	auto multiTexVSCode = byteCode(L"multiTexVS.cso"), multiTexPSCode = byteCode(L"multiTexPS.cso");
+	auto particleVSCode = byteCode(L"particleVS.cso"), particlePSCode = byteCode(L"particlePS.cso");
+	auto particleGSCode = byteCode(L"particleGS.cso");
+	auto shadowVolumeVSCode = byteCode(L"shadowVolumeVS.cso");
+
 	//Projection matrix
 	auto s = m_window.getClientSize();
 	auto ar = static_cast<float>(s.cx) / s.cy;
-	DirectX::XMStoreFloat4x4(&m_projMtx, XMMatrixPerspectiveFovLH(XM_PIDIV4, ar, 0.01f, 100.0f));
+	DirectX::XMStoreFloat4x4(&m_projMtx, InfinitePerspectiveFovLH(XM_PIDIV4, ar, 0.01f));
 	UpdateBuffer(m_cbProjMtx, m_projMtx);
 	UpdateCameraCB();
 
@@ -34,14 +82,18 @@ Puma::Puma(HINSTANCE appInstance)
 	vector<unsigned short> indices;
 	for (int i = 0; i < 6; i++)
 	{
-		m_manipulator[i] = SMMesh::LoadMesh(m_device, L"resources/meshes/mesh" + std::to_wstring(i + 1) + L".txt");
+		m_manipulator[i] = assets.Get(manipulator[i]);
+		m_manipulator[i].CreateBuffers(m_device, true);
 		XMStoreFloat4x4(&m_manipulatorMtx[i], XMMatrixIdentity());
+		// ramiona poruszaja sie plynnie - sylwetka sledzona miedzy klatkami
+		m_manipulator[i].EnableTemporalCoherence();
 	}
 
-	m_cylinder = SMMesh::Cylinder(m_device, 20, 20, 3.f, 0.5f);
+	m_cylinder = assets.Get(cylinder);
+	m_cylinder.CreateBuffers(m_device);
 	m_box = Mesh::ShadedBox(m_device, 5.f);
-	m_mirror = SMMesh::DoubleRect(m_device, 1.5f, 1.f);
-	XMStoreFloat4x4(&m_mirrorMtx, XMMatrixRotationY(XM_PIDIV2) * XMMatrixRotationZ(XM_PIDIV4) * XMMatrixTranslation(-1.5f, 0.25f, -0.5f));
+	m_mirror = assets.Get(mirror);
+	m_mirror.CreateBuffers(m_device);
 
 	mirrorNormal = { 1.f / sqrtf(2), 1.f / sqrtf(2), 0, 0 };
 	mirrorPoint = { -1.5f, 0.25f, -0.5f, 1 };
@@ -118,44 +170,42 @@ Puma::Puma(HINSTANCE appInstance)
 
 
 	//Textures
-	auto vsCode = m_device.LoadByteCode(L"phongVS.cso");
-	auto psCode = m_device.LoadByteCode(L"phongPS.cso");
+	m_particleTexture = m_device.CreateShaderResourceView(assets.Get(particleTexture), particleTexturePath);
+
+	auto vsCode = assets.Get(phongVSCode);
 	m_phongVS = m_device.CreateVertexShader(vsCode);
-	m_phongPS = m_device.CreatePixelShader(psCode);
+	m_phongPS = m_device.CreatePixelShader(assets.Get(phongPSCode));
 	m_inputlayout = m_device.CreateInputLayout(VertexPositionNormal::Layout, vsCode);
+	m_quantizedLayout = m_device.CreateInputLayout(VertexPositionNormalQuantized::Layout, vsCode);
+	UpdateBuffer(m_cbVertexDecode, m_vertexDecode);
 
-	vsCode = m_device.LoadByteCode(L"phongVSMirror.cso");
-	psCode = m_device.LoadByteCode(L"phongPSMirror.cso");
-	m_phongVSMirror = m_device.CreateVertexShader(vsCode);
-	m_phongPSMirror = m_device.CreatePixelShader(psCode);
-
-	vsCode = m_device.LoadByteCode(L"texturedVS.cso");
-	psCode = m_device.LoadByteCode(L"texturedPS.cso");
-	m_textureVS = m_device.CreateVertexShader(vsCode);
-	m_texturePS = m_device.CreatePixelShader(psCode);
-	psCode = m_device.LoadByteCode(L"colorTexPS.cso");
-	m_colorTexPS = m_device.CreatePixelShader(psCode);
-
-	vsCode = m_device.LoadByteCode(L"multiTexVS.cso");
-	psCode = m_device.LoadByteCode(L"multiTexPS.cso");
-	m_multiTexVS = m_device.CreateVertexShader(vsCode);
-	m_multiTexPS = m_device.CreatePixelShader(psCode);
-
-	vsCode = m_device.LoadByteCode(L"particleVS.cso");
-	psCode = m_device.LoadByteCode(L"particlePS.cso");
-	auto gsCode = m_device.LoadByteCode(L"particleGS.cso");
+	m_phongVSMirror = m_device.CreateVertexShader(assets.Get(phongVSMirrorCode));
+	m_phongPSMirror = m_device.CreatePixelShader(assets.Get(phongPSMirrorCode));
+
+	m_textureVS = m_device.CreateVertexShader(assets.Get(texturedVSCode));
+	m_texturePS = m_device.CreatePixelShader(assets.Get(texturedPSCode));
+	m_colorTexPS = m_device.CreatePixelShader(assets.Get(colorTexPSCode));
+
+	m_multiTexVS = m_device.CreateVertexShader(assets.Get(multiTexVSCode));
+	m_multiTexPS = m_device.CreatePixelShader(assets.Get(multiTexPSCode));
+
+	vsCode = assets.Get(particleVSCode);
 	m_particleVS = m_device.CreateVertexShader(vsCode);
-	m_particlePS = m_device.CreatePixelShader(psCode);
-	m_particleGS = m_device.CreateGeometryShader(gsCode);
-	m_particleLayout = m_device.CreateInputLayout<ParticleVertex>(vsCode);
+	m_particlePS = m_device.CreatePixelShader(assets.Get(particlePSCode));
+	m_particleGS = m_device.CreateGeometryShader(assets.Get(particleGSCode));
+	m_particleLayout = m_device.CreateInputLayout(ParticleVertexLayout, vsCode);
+
+	vsCode = assets.Get(shadowVolumeVSCode);
+	m_shadowVolumeVS = m_device.CreateVertexShader(vsCode);
+	m_shadowVolumeLayout = m_device.CreateInputLayout<VertexPositionHomogeneous>(vsCode);
 
 	m_device.context()->IASetInputLayout(m_inputlayout.get());
 	m_device.context()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 	//We have to make sure all shaders use constant buffers in the same slots!
 	//Not all slots will be use by each shader
-	ID3D11Buffer* vsb[] = { m_cbWorldMtx.get(),  m_cbViewMtx.get(), m_cbProjMtx.get(), m_cbMirrorBuf.get() };
-	m_device.context()->VSSetConstantBuffers(0, 4, vsb); //Vertex Shaders - 0: worldMtx, 1: viewMtx,invViewMtx, 2: projMtx, 3: tex1Mtx, 4: tex2Mtx
+	ID3D11Buffer* vsb[] = { m_cbWorldMtx.get(),  m_cbViewMtx.get(), m_cbProjMtx.get(), m_cbMirrorBuf.get(), m_cbVertexDecode.get() };
+	m_device.context()->VSSetConstantBuffers(0, 5, vsb); //Vertex Shaders - 0: worldMtx, 1: viewMtx,invViewMtx, 2: projMtx, 3: mirror, 4: vertexDecode
 	m_device.context()->GSSetConstantBuffers(0, 1, vsb + 2); //Geometry Shaders - 0: projMtx
 	ID3D11Buffer* psb[] = { m_cbSurfaceColor.get(), m_cbLightPos.get(), m_cbShadowControl.get() };
 	m_device.context()->PSSetConstantBuffers(0, 3, psb); //Pixel Shaders - 0: surfaceColor, 1: lightPos, 2: shadowControl
@@ -168,180 +218,124 @@ void Puma::UpdateCameraCB(XMMATRIX viewMtx)
 	XMFLOAT4X4 view[2];
 	DirectX::XMStoreFloat4x4(view, viewMtx);
 	DirectX::XMStoreFloat4x4(view + 1, invViewMtx);
+	m_invViewMtx = view[1];
 	UpdateBuffer(m_cbViewMtx, view);
 }
 
-void Puma::HandleManipulatorInput(double dt)
+ManipulatorInput Puma::HandleManipulatorInput()
 {
 	KeyboardState keyboard;
 	float speed = 0.5f;
+	ManipulatorInput input;
 	if (!m_keyboard.GetState(keyboard))
-		return;
+		return input;
 	if (keyboard.isKeyDown(DIK_C)) {
-		m_animation = !m_animation;
+		m_simulation.SetAnimation(!m_simulation.Animation());
 	}
 
-	if (keyboard.isKeyDown(DIK_F))
-	{
-		m_manipulatorAngle[0] += speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_R))
+	// predkosci przegubow trzymane przez wszystkie kroki symulacji w tej klatce
+	const unsigned char keys[PumaJointCount][2] = {
+		{ DIK_F, DIK_R }, { DIK_G, DIK_T }, { DIK_H, DIK_Y }, { DIK_J, DIK_U }, { DIK_K, DIK_I } };
+	for (size_t j = 0; j < PumaJointCount; ++j)
 	{
-		m_manipulatorAngle[0] -= speed * dt;
-		m_animation = false;
+		if (keyboard.isKeyDown(keys[j][0]))
+			input.jointVelocity[j] += speed;
+		if (keyboard.isKeyDown(keys[j][1]))
+			input.jointVelocity[j] -= speed;
 	}
-	if (keyboard.isKeyDown(DIK_G))
-	{
-		m_manipulatorAngle[1] += speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_T))
-	{
-		m_manipulatorAngle[1] -= speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_H))
-	{
-		m_manipulatorAngle[2] += speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_Y))
-	{
-		m_manipulatorAngle[2] -= speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_J))
-	{
-		m_manipulatorAngle[3] += speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_U))
-	{
-		m_manipulatorAngle[3] -= speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_K))
-	{
-		m_manipulatorAngle[4] += speed * dt;
-		m_animation = false;
-	}
-	if (keyboard.isKeyDown(DIK_I))
-	{
-		m_manipulatorAngle[4] -= speed * dt;
-		m_animation = false;
-	}
-
-	UpdateManipulatorMtx();
+	return input;
 }
 
-void Puma::ManipulatorAnimation(double dt)
+void Puma::UpdateSimulation(double dt)
 {
-	const float r = 0.4f;
-	static float t = 0.f;
-	t += static_cast<float>(dt);
-	XMFLOAT3 pos = { r * cosf(t), r * sinf(t), 0.f };
-	XMFLOAT3 normal = { 0.f, 0.f, -1.f };
-
-	XMVECTOR p = XMLoadFloat3(&pos);
-	XMVECTOR n = XMLoadFloat3(&normal);
-
-	XMMATRIX mirror = XMLoadFloat4x4(&m_mirrorMtx);
-	XMMATRIX invmirror = XMMatrixInverse(nullptr, mirror);
-
-	XMVECTOR p3 = XMVector3TransformCoord(p, mirror);
-	XMVECTOR n3 = XMVector3TransformNormal(n, invmirror);
-
-	XMStoreFloat3(&pos, p3);
-	XMStoreFloat3(&normal, n3);
-
-	InverseKinematics(pos, normal);
-	UpdateManipulatorMtx();
-	m_particleSystem.SetEmitterPosition(pos);
+	// staly krok niezalezny od liczby klatek - ten sam stan przy kazdej predkosci rysowania
+	ManipulatorInput input = HandleManipulatorInput();
+	for (unsigned int steps = m_simulationClock.Advance(dt); steps > 0; --steps)
+		m_simulation.Step(static_cast<float>(m_simulationClock.Step()), input);
+
+	// rysowany stan miedzy dwoma ostatnimi krokami
+	float alpha = m_simulationClock.Alpha();
+	m_simulation.LinkMatrices(alpha, m_manipulatorMtx);
+	UpdateBuffer(m_vbParticleSystem, m_simulation.ParticleVertices(m_camera.getCameraPosition(), alpha));
 }
 
-void Puma::InverseKinematics(XMFLOAT3 pos, XMFLOAT3 normal)
+void mini::gk2::Puma::GenerateShadowVolumes()
 {
-	float l1 = .91f;
-	float l2 = .81f;
-	float l3 = .33f;
-	float dy = .27f;
-	float dz = .26f;
-
-	XMVECTOR nor = XMLoadFloat3(&normal);
-	XMVECTOR posV = XMLoadFloat3(&pos);
-	nor = XMVector3Normalize(nor);
-	XMVECTOR p1 = XMVectorAdd(posV, XMVectorScale(nor, l3));
-	XMFLOAT3 p1f;
-	XMStoreFloat3(&p1f, p1);
-
-	float e = sqrtf(p1f.x * p1f.x + p1f.z * p1f.z - dz * dz);
-	m_manipulatorAngle[0] = atan2f(p1f.z, -p1f.x) + atan2f(dz, e);
-
-	XMFLOAT3 pos2 = XMFLOAT3(e, p1f.y - dy, 0.0f);
-
-	float dot = pos2.x * pos2.x + pos2.y * pos2.y + pos2.z * pos2.z - l1 * l1 - l2 * l2;
-	float denom = 2.0f * l1 * l2;
-	m_manipulatorAngle[2] = -acosf(min(1.0f, dot / denom));
-
-	float k = l1 + l2 * cosf(m_manipulatorAngle[2]);
-	float l = l2 * sinf(m_manipulatorAngle[2]);
-	m_manipulatorAngle[1] = -atan2f(pos2.y, sqrtf(pos2.x * pos2.x + pos2.z * pos2.z)) - atan2f(l, k);
-
-	XMVECTOR normal1 = XMVector3TransformNormal(nor, XMMatrixRotationY(-m_manipulatorAngle[0]));
-	normal1 = XMVector3TransformNormal(normal1, XMMatrixRotationZ(-(m_manipulatorAngle[1] + m_manipulatorAngle[2])));
-
-	XMFLOAT3 n1;
-	XMStoreFloat3(&n1, normal1);
-	m_manipulatorAngle[4] = acosf(n1.x);
-	m_manipulatorAngle[3] = atan2f(n1.z, n1.y);
-}
+	// wierzcholki dolnych czepcow i krawedzi w nieskonczonosci
+	const float extrusionDistance = InfiniteExtrusion;
+	const XMFLOAT3 lightPos = { LIGHT_POS.x, LIGHT_POS.y, LIGHT_POS.z };
+	std::pair<SMMesh*, const XMFLOAT4X4*> casters[] = {
+		{ &m_manipulator[0], &m_manipulatorMtx[0] }, { &m_manipulator[1], &m_manipulatorMtx[1] },
+		{ &m_manipulator[2], &m_manipulatorMtx[2] }, { &m_manipulator[3], &m_manipulatorMtx[3] },
+		{ &m_manipulator[4], &m_manipulatorMtx[4] }, { &m_manipulator[5], &m_manipulatorMtx[5] },
+		{ &m_cylinder, &m_cylinderMtx }, { &m_mirror, &m_mirrorMtx },
+	};
+	bool rebuilt[std::size(casters)];
+	// uproszczone bryly dla odleglych siatek, blad najwyzej jednego piksela
+	auto s = m_window.getClientSize();
+	XMFLOAT4 eye = m_camera.getCameraPosition();
+	const LodView view = { { eye.x, eye.y, eye.z }, 0.5f * s.cy * m_projMtx._22, 1.f };
 
-void mini::gk2::Puma::UpdateManipulatorMtx()
-{
-	XMMATRIX mtx[6];
-	mtx[0] = XMMatrixIdentity();
-	mtx[1] = XMMatrixRotationY(m_manipulatorAngle[0]);
-	mtx[2] = XMMatrixTranslation(0, -0.27f, 0) * XMMatrixRotationZ(m_manipulatorAngle[1]) * XMMatrixTranslation(0, 0.27f, 0) * mtx[1];
-	mtx[3] = XMMatrixTranslation(0.91f, -0.27f, 0) * XMMatrixRotationZ(m_manipulatorAngle[2]) * XMMatrixTranslation(-0.91f, 0.27f, 0) * mtx[2];
-	mtx[4] = XMMatrixTranslation(0, -0.27f, 0.26f) * XMMatrixRotationX(m_manipulatorAngle[3]) * XMMatrixTranslation(0, 0.27f, -0.26f) * mtx[3];
-	mtx[5] = XMMatrixTranslation(1.72f, -0.27, 0) * XMMatrixRotationZ(m_manipulatorAngle[4]) * XMMatrixTranslation(-1.72f, 0.27f, 0) * mtx[4];
-
-	XMStoreFloat4x4(&m_manipulatorMtx[0], mtx[0]);
-	XMStoreFloat4x4(&m_manipulatorMtx[1], mtx[1]);
-	XMStoreFloat4x4(&m_manipulatorMtx[2], mtx[2]);
-	XMStoreFloat4x4(&m_manipulatorMtx[3], mtx[3]);
-	XMStoreFloat4x4(&m_manipulatorMtx[4], mtx[4]);
-	XMStoreFloat4x4(&m_manipulatorMtx[5], mtx[5]);
-}
+	// czesc CPU rownolegle, kazda bryla w osobnym zadaniu
+	m_jobs.ParallelFor(std::size(casters), [&](size_t i)
+	{
+		rebuilt[i] = casters[i].first->BuildShadowVolume(lightPos, *casters[i].second, extrusionDistance, &view);
+	});
 
-void mini::gk2::Puma::UpdateParticleSystem(double dt)
-{
-	auto verts = m_particleSystem.Update(static_cast<float>(dt), m_camera.getCameraPosition());
-	UpdateBuffer(m_vbParticleSystem, verts);
+	// przesylanie do GPU tylko z watku renderujacego
+	m_shadowStats = {};
+	for (size_t i = 0; i < std::size(casters); ++i)
+	{
+		if (rebuilt[i])
+		{
+			casters[i].first->UploadShadowVolume(m_device);
+			++m_shadowStats.rebuilt;
+			m_shadowStats.edgesTested += casters[i].first->SilhouetteTestedFraction();
+			m_shadowStats.simplified += casters[i].first->ShadowLevel() > 0;
+		}
+		else
+			++m_shadowStats.reused;
+		m_shadowStats.totalBufferReallocations += casters[i].first->ShadowBufferReallocations();
+	}
+	if (m_shadowStats.rebuilt)
+		m_shadowStats.edgesTested /= m_shadowStats.rebuilt;
 }
 
-void mini::gk2::Puma::GenerateShadowVolumes()
+void mini::gk2::Puma::UpdateFrameStats(const Clock& c)
 {
-	const float extrusionDistance = 10.f;
-	for (int i = 0; i < 6; i++)
-	{
-		m_manipulator[i].GenerateShadowVolume(m_device, { LIGHT_POS.x, LIGHT_POS.y, LIGHT_POS.z }, m_manipulatorMtx[i], extrusionDistance);
-	}
-	m_cylinder.GenerateShadowVolume(m_device, { LIGHT_POS.x, LIGHT_POS.y, LIGHT_POS.z }, m_cylinderMtx, extrusionDistance);
-	m_mirror.GenerateShadowVolume(m_device, { LIGHT_POS.x, LIGHT_POS.y, LIGHT_POS.z }, m_mirrorMtx, extrusionDistance);
+	// statystyki w tytule okna, raz na sekunde
+	m_statsTime += c.getFrameTime();
+	if (m_statsTime < 1.0)
+		return;
+	m_statsTime = 0.0;
+	const DlsStats& ikStats = m_simulation.IkStats();
+	auto title = L"Pokój - " + to_wstring(static_cast<int>(c.getFPS())) + L" FPS, bryly cienia: "
+		+ to_wstring(m_shadowStats.rebuilt) + L" przebudowane, " + to_wstring(m_shadowStats.reused) + L" ponownie uzyte, "
+		+ to_wstring(m_shadowStats.totalBufferReallocations) + L" alokacji buforow od startu, "
+		+ to_wstring(static_cast<int>(100.f * m_shadowStats.edgesTested)) + L"% krawedzi testowanych, "
+		+ to_wstring(m_shadowStats.simplified) + L" uproszczone, IK DLS: " + to_wstring(ikStats.solves) + L" rozwiazan, "
+		+ to_wstring(ikStats.AverageIterations()) + L" iteracji, " + to_wstring(ikStats.AverageMicroseconds()) + L" us";
+	m_simulation.ResetIkStats();
+	SetWindowTextW(m_window.getHandle(), title.c_str());
 }
 
 void mini::gk2::Puma::DrawShadowVolumes()
 {
-	XMFLOAT4X4 mtx;
-	XMStoreFloat4x4(&mtx, DirectX::XMMatrixIdentity());
+	// tylko bufor szablonu - bez pixel shadera
+	m_device.context()->IASetInputLayout(m_shadowVolumeLayout.get());
+	m_device.context()->VSSetShader(m_shadowVolumeVS.get(), nullptr, 0);
+	m_device.context()->PSSetShader(nullptr, nullptr, 0);
+
+	// bryly cienia sa w ukladzie obiektu
 	for (int i = 0; i < 6; i++)
 	{
-		DrawShadowVolume(m_manipulator[i], mtx);
+		DrawShadowVolume(m_manipulator[i], m_manipulatorMtx[i]);
 	}
-	DrawShadowVolume(m_cylinder, mtx);
-	DrawShadowVolume(m_mirror, mtx);
+	DrawShadowVolume(m_cylinder, m_cylinderMtx);
+	DrawShadowVolume(m_mirror, m_mirrorMtx);
+
+	m_device.context()->IASetInputLayout(m_inputlayout.get());
+	SetShaders(m_phongVS, m_phongPS);
 }
 
 
@@ -349,15 +343,11 @@ void Puma::Update(const Clock& c)
 {
 	double dt = c.getFrameTime();
 	HandleCameraInput(dt);
-	HandleManipulatorInput(dt);
-	if (m_animation)
-	{
-		ManipulatorAnimation(dt);
-		UpdateParticleSystem(dt);
-	}
+	UpdateSimulation(dt);
 
 	auto xx = m_camera.getCameraPosition();
 	UpdateCameraCB();
+	UpdateFrameStats(c);
 }
 
 void Puma::SetWorldMtx(DirectX::XMFLOAT4X4 mtx)
@@ -365,6 +355,16 @@ void Puma::SetWorldMtx(DirectX::XMFLOAT4X4 mtx)
 	UpdateBuffer(m_cbWorldMtx, mtx);
 }
 
+void Puma::SetVertexFormat(const VertexDecode& decode)
+{
+	m_device.context()->IASetInputLayout(decode.Quantized() ? m_quantizedLayout.get() : m_inputlayout.get());
+	// bufor aktualizowany tylko przy zmianie siatki o innym prostopadloscianie
+	if (memcmp(&decode, &m_vertexDecode, sizeof(VertexDecode)) == 0)
+		return;
+	m_vertexDecode = decode;
+	UpdateBuffer(m_cbVertexDecode, m_vertexDecode);
+}
+
 void Puma::SetSurfaceColor(DirectX::XMFLOAT4 color)
 {
 	UpdateBuffer(m_cbSurfaceColor, color);
@@ -386,6 +386,7 @@ void mini::gk2::Puma::SetTextures(std::initializer_list<ID3D11ShaderResourceView
 void Puma::DrawMesh(const Mesh& m, DirectX::XMFLOAT4X4 worldMtx)
 {
 	SetWorldMtx(worldMtx);
+	SetVertexFormat(VertexDecode());
 	m.Render(m_device.context());
 }
 
@@ -444,7 +445,12 @@ void mini::gk2::Puma::DrawManipulators()
 void Puma::DrawMesh(const SMMesh& m, DirectX::XMFLOAT4X4 worldMtx)
 {
 	SetWorldMtx(worldMtx);
-	m.Render(m_device.context());
+	SetVertexFormat(m.VertexDecoding());
+	// kamera w ukladzie obiektu (takze odbita) - meshlety odwrocone od niej nie sa rysowane
+	XMVECTOR eye = XMLoadFloat4x4(&m_invViewMtx).r[3];
+	XMFLOAT3 objectEye;
+	XMStoreFloat3(&objectEye, XMVector3Transform(eye, XMMatrixInverse(nullptr, XMLoadFloat4x4(&worldMtx))));
+	m.Render(m_device.context(), objectEye);
 }
 
 void mini::gk2::Puma::DrawShadowVolume(const SMMesh& m, DirectX::XMFLOAT4X4 worldMtx)
@@ -470,7 +476,7 @@ void mini::gk2::Puma::DrawBox()
 
 void Puma::DrawParticleSystem()
 {
-	if (m_particleSystem.particlesCount() == 0)
+	if (m_simulation.Particles().particlesCount() == 0)
 		return;
 	//Set input layout, primitive topology, shaders, vertex buffer, and draw particles
 	ID3D11DepthStencilState* stencilState = nullptr;
@@ -489,7 +495,7 @@ void Puma::DrawParticleSystem()
 	unsigned int offset = 0;
 	auto vb = m_vbParticleSystem.get();
 	m_device.context()->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
-	m_device.context()->Draw(m_particleSystem.particlesCount(), 0);
+	m_device.context()->Draw(static_cast<UINT>(m_simulation.Particles().particlesCount()), 0);
 
 	//Reset layout, primitive topology and geometry shader
 	m_device.context()->GSSetShader(nullptr, nullptr, 0);
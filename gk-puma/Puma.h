@@ -3,7 +3,8 @@
 #include "mesh.h"
 #include "SMMesh.h"
 #include "environmentMapper.h"
-#include "particleSystem.h"
+#include "jobSystem.h"
+#include "pumaSimulation.h"
 
 namespace mini::gk2
 {
@@ -26,6 +27,8 @@ namespace mini::gk2
 			m_cbProjMtx;	//vertex shader constant buffer slot 2 & geometry shader constant buffer slot 0
 		dx_ptr<ID3D11Buffer> m_cbViewMtx; //vertex shader constant buffer slot 1
 		dx_ptr<ID3D11Buffer> m_cbMirrorBuf; //vertex shader constant buffer slot 3
+		dx_ptr<ID3D11Buffer> m_cbVertexDecode; //vertex shader constant buffer slot 4
+		VertexDecode m_vertexDecode; //constants currently in m_cbVertexDecode
 		dx_ptr<ID3D11Buffer> m_cbSurfaceColor;	//pixel shader constant buffer slot 0
 		dx_ptr<ID3D11Buffer> m_cbLightPos; //pixel shader constant buffer slot 1
 		dx_ptr<ID3D11Buffer> m_cbShadowControl; //pixel shader constant buffer slot 2
@@ -42,14 +45,30 @@ namespace mini::gk2
 		XMFLOAT4 mirrorNormal;
 
 		DirectX::XMFLOAT4X4 m_projMtx;
+		DirectX::XMFLOAT4X4 m_invViewMtx; //inverse of the view matrix in m_cbViewMtx
 		DirectX::XMFLOAT4X4 m_mirrorMtx;
 
-		DirectX::XMFLOAT4X4 m_manipulatorMtx[6];
+		//Arm and particles advanced in fixed steps, rendered between the last two of them
+		FixedStepClock m_simulationClock;
+		PumaSimulation m_simulation;
+		DirectX::XMFLOAT4X4 m_manipulatorMtx[PumaLinkCount];
 		DirectX::XMFLOAT4X4 m_cylinderMtx;
-		float m_manipulatorAngle[5];
-		bool m_animation;
 
-		ParticleSystem m_particleSystem;
+		//Shadow volume statistics of the last frame
+		struct ShadowStats
+		{
+			unsigned int rebuilt = 0;
+			unsigned int reused = 0;
+			//Shadow buffer reallocations of all casters since the start, a running total unlike the rest
+			unsigned int totalBufferReallocations = 0;
+			//Mean fraction of edges tested by the silhouette tests of rebuilt volumes
+			float edgesTested = 0.f;
+			//Rebuilt volumes made from simplified casters
+			unsigned int simplified = 0;
+		} m_shadowStats;
+		double m_statsTime = 0.0;
+
+		JobSystem m_jobs;
 
 		dx_ptr<ID3D11RasterizerState> m_rsNoCull;
 		dx_ptr<ID3D11RasterizerState> m_rsCullFront;
@@ -66,19 +85,17 @@ namespace mini::gk2
 		dx_ptr<ID3D11DepthStencilState> m_dssStencilShadowVolume;
 		dx_ptr<ID3D11SamplerState> m_samplerWrap;
 
-		dx_ptr<ID3D11InputLayout> m_inputlayout, m_particleLayout;
+		dx_ptr<ID3D11InputLayout> m_inputlayout, m_quantizedLayout, m_particleLayout, m_shadowVolumeLayout;
 
-		dx_ptr<ID3D11VertexShader> m_phongVS, m_phongVSMirror, m_textureVS, m_multiTexVS, m_particleVS;
+		dx_ptr<ID3D11VertexShader> m_phongVS, m_phongVSMirror, m_textureVS, m_multiTexVS, m_particleVS, m_shadowVolumeVS;
 		dx_ptr<ID3D11GeometryShader> m_particleGS;
 		dx_ptr<ID3D11PixelShader> m_phongPS, m_phongPSMirror, m_texturePS, m_colorTexPS, m_multiTexPS, m_particlePS;
 
 		void UpdateCameraCB(DirectX::XMMATRIX viewMtx);
 		void UpdateCameraCB() { UpdateCameraCB(m_camera.getViewMatrix()); }
-		void HandleManipulatorInput(double dt);
-		void ManipulatorAnimation(double dt);
-		void InverseKinematics(DirectX::XMFLOAT3 pos, DirectX::XMFLOAT3 normal);
-		void UpdateManipulatorMtx();
-		void UpdateParticleSystem(double dt);
+		ManipulatorInput HandleManipulatorInput();
+		void UpdateSimulation(double dt);
+		void UpdateFrameStats(const Clock& c);
 
 		void GenerateShadowVolumes();
 		void DrawShadowVolumes();
@@ -94,6 +111,8 @@ namespace mini::gk2
 		void DrawShadowVolume(const SMMesh& m, DirectX::XMFLOAT4X4 worldMtx);
 
 		void SetWorldMtx(DirectX::XMFLOAT4X4 mtx);
+		//Input layout and decoding constants for float or quantized vertices
+		void SetVertexFormat(const VertexDecode& decode);
 		void SetSurfaceColor(DirectX::XMFLOAT4 color);
 		void SetShaders(const dx_ptr<ID3D11VertexShader>& vs, const dx_ptr<ID3D11PixelShader>& ps);
 		void SetTextures(std::initializer_list<ID3D11ShaderResourceView*> resList, const dx_ptr<ID3D11SamplerState>& sampler);
@@ -2,73 +2,98 @@
 #include "DirectXMath.h"
 #include "mesh.h"
 #include "vertexTypes.h"
-#include <map> 
+#include "shadowVolume.h"
+#include "meshFile.h"
 
 using namespace DirectX;
 using namespace mini;
 
-struct Edge {
-	unsigned v0, v1;
-	unsigned face0, face1;
-	
-	Edge() {}
-
-	Edge(unsigned v0, unsigned v1, unsigned face0, unsigned face1)
-		: v0(v0), v1(v1), face0(face0), face1(face1)
-	{
-	}
-};
-
-struct Face
-{
-	unsigned indices[3];
-	Face() {}
-	Face(unsigned v0, unsigned v1, unsigned v2)
-	{
-		indices[0] = v0;
-		indices[1] = v1;
-		indices[2] = v2;
-	}
-};
-
 class SMMesh
 {
 	Mesh mesh;
-	Mesh shadowMesh;
-	std::vector<XMFLOAT3> positions;
+	// dynamiczne bufory bryly cienia, powiekszane tylko gdy brakuje miejsca
+	dx_ptr<ID3D11Buffer> shadowVertexBuffer;
+	dx_ptr<ID3D11Buffer> shadowIndexBuffer;
+	unsigned int shadowVertexCapacity = 0;
+	unsigned int shadowIndexCapacity = 0;
+	unsigned int shadowIndexCount = 0;
+	DXGI_FORMAT shadowIndexFormat = DXGI_FORMAT_R16_UINT;
+	unsigned int shadowBufferReallocations = 0;
+	// stan (macierz swiata, swiatlo), dla ktorego wygenerowano aktualna bryle cienia
+	XMFLOAT4X4 shadowWorldMtx = {};
+	XMFLOAT3 shadowLightPos = {};
+	float shadowExtrusion = -1.f;
+	unsigned int shadowVersion = 0;
 	std::vector<VertexPositionNormal> vertices;
-	std::vector<Edge> edges;
-	std::vector<Face> faces;
-	bool FacingFront(const Face& face, const XMVECTOR& lightPos, const std::vector<VertexPositionNormal>& worldVertices);
-	bool isEdgeOriented(unsigned v0, unsigned v1, const Face& face);
-	bool SameFloat3(XMFLOAT3 v1, XMFLOAT3 v2);
-	void generateExtrudedQuadForEdge(
-		const Edge& edge,
-		const std::vector<XMFLOAT3>& worldPositions,
-		const XMVECTOR& lightPos,
-		float extrusionDistance,
-		std::vector<VertexPositionNormal>& shadowVertices,
-		std::vector<unsigned short>& shadowIndices
-	);
-
-	void AddEdge(std::map<std::pair<unsigned short, unsigned short>, Edge>& edgeMap, unsigned short v0, unsigned short v1, unsigned short face);
+	// indeksy do utworzenia bufora w CreateBuffers
+	std::vector<unsigned int> indices;
+	ShadowCaster caster;
+	ShadowVolume shadowVolume;
+	// uproszczone bryly cienia i poziom uzyty w ostatniej bryle
+	ShadowLodChain shadowLods;
+	size_t shadowLevel = 0;
+	// stale dekodowania wierzcholkow w buforze (domyslne dla wierzcholkow float)
+	VertexDecode vertexDecode;
+	// zakresy scian widocznych meshletow, odtwarzane przy kazdym rysowaniu
+	mutable std::vector<FaceRange> visibleFaces;
+	mutable std::vector<Mesh::IndexRange> visibleIndices;
+	void PrepareCaster();
+	void ReserveShadowBuffers(const DxDevice& device, size_t vertexCount, size_t indexCount);
 
 	void CylinderPositions(unsigned int stacks, unsigned int slices, float height, float radius);
-	std::vector<unsigned short> CylinderVerts(unsigned int stacks, unsigned int slices, float height, float radius);
-	std::vector<unsigned short> CylinderIdx(unsigned int stacks, unsigned int slices, const std::vector<unsigned short>& vertexPositionMapping);
+	void CylinderVerts(unsigned int stacks, unsigned int slices, float height, float radius);
+	std::vector<unsigned int> CylinderIdx(unsigned int stacks, unsigned int slices);
+
+	static SMMesh FromMeshView(const MeshView& view);
 
 	void DoubleRectPositions(float width, float height);
-	std::vector<unsigned short> DoubleRectVerts();
-	std::vector<unsigned short> DoubleRectIdx(const std::vector<unsigned short>& vertexPositionMapping);
+	void DoubleRectVerts();
+	std::vector<unsigned int> DoubleRectIdx();
 public:
 public:
 	void Render(const dx_ptr<ID3D11DeviceContext>& context) const;
+	//Skips meshlets turned away from eye (given in object space)
+	void Render(const dx_ptr<ID3D11DeviceContext>& context, XMFLOAT3 eye) const;
 	void RenderShadowVolume(const dx_ptr<ID3D11DeviceContext>& context) const;
-	void GenerateShadowVolume(const DxDevice& device, XMFLOAT3 lightPos, XMFLOAT4X4 worldMtx, float extrusionDistance);
-	static SMMesh LoadMesh(const DxDevice& device, const std::wstring& meshPath);
+	//Returns false if the volume for the same world matrix and light was already generated and is reused
+	//With view, the volume is made from the shadow level of detail chosen for the view (see BuildShadowLods)
+	bool GenerateShadowVolume(const DxDevice& device, XMFLOAT3 lightPos, XMFLOAT4X4 worldMtx, float extrusionDistance,
+		const LodView* view = nullptr);
+	//CPU half of GenerateShadowVolume, does not touch the device and may run on any thread
+	bool BuildShadowVolume(XMFLOAT3 lightPos, const XMFLOAT4X4& worldMtx, float extrusionDistance, const LodView* view = nullptr);
+	//Simplified shadow casters for distant views (see ShadowLodChain), CPU only
+	void BuildShadowLods(size_t minFaces = 64) { shadowLods.Build(caster, minFaces); }
+	//Level of detail of the last shadow volume, 0 for the full mesh
+	size_t ShadowLevel() const { return shadowLevel; }
+	//GPU half of GenerateShadowVolume, copies the last built volume to the buffers
+	void UploadShadowVolume(const DxDevice& device);
+	//Meshlets skipped by the last silhouette extraction (meshlets are not used with temporal coherence)
+	size_t SkippedMeshlets() const { return shadowVolume.skippedMeshlets; }
+	size_t MeshletCount() const { return caster.Meshlets().size(); }
+	//Incremented every time the shadow volume is rebuilt
+	unsigned int ShadowVersion() const { return shadowVersion; }
+	//Number of times the shadow volume buffers had to be (re)created
+	unsigned int ShadowBufferReallocations() const { return shadowBufferReallocations; }
+	//Updates the silhouette incrementally between frames, for casters that move smoothly
+	void EnableTemporalCoherence(bool enable = true) { shadowVolume.temporalCoherence = enable; shadowVolume.tracker.Reset(); }
+	//Fraction of edges tested in the last rebuild (1 without temporal coherence)
+	float SilhouetteTestedFraction() const { return shadowVolume.temporalCoherence ? shadowVolume.tracker.TestedFraction() : 1.f; }
+	//Text mesh, or binary mesh if the path ends with BinaryMeshExtension; throws std::runtime_error on malformed files.
+	//optimizeVertexOrder reorders triangles and vertices for the vertex caches (see OptimizeVertexOrder).
+	static SMMesh LoadMesh(const DxDevice& device, const std::wstring& meshPath, bool optimizeVertexOrder = false);
 
 	static SMMesh Cylinder(const DxDevice& device, unsigned int stacks, unsigned int slices, float height, float radius);
 	static SMMesh DoubleRect(const DxDevice& device, float width, float height);
+
+	//CPU halves of the factories above: geometry and shadow caster data without device buffers,
+	//may run on any thread. CreateBuffers must be called on the device thread before rendering.
+	static SMMesh LoadMesh(const std::wstring& meshPath, bool optimizeVertexOrder = false);
+	static SMMesh Cylinder(unsigned int stacks, unsigned int slices, float height, float radius);
+	static SMMesh DoubleRect(float width, float height);
+	//quantizeVertices stores VertexPositionNormalQuantized vertices (input layout and VertexDecoding must match)
+	void CreateBuffers(const DxDevice& device, bool quantizeVertices = false);
+	//Constants for cbVertexDecode in phongVS
+	const VertexDecode& VertexDecoding() const { return vertexDecode; }
 	
 };
 
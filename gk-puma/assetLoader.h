@@ -0,0 +1,30 @@
+#pragma once
+#include "jobSystem.h"
+
+//Startup asset loading: file reads and parsing run as jobs and return futures,
+//the device thread creates Direct3D objects from the results as they arrive.
+
+namespace mini
+{
+	class AssetLoader
+	{
+	public:
+		explicit AssetLoader(JobSystem& jobs) : m_jobs(jobs) { }
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader& operator=(const AssetLoader&) = delete;
+		//Waits for loads still running, e.g. when an earlier Get threw
+		~AssetLoader() { m_jobs.Wait(m_pending); }
+
+		//load() runs on any thread, it must not touch the device
+		template<typename F>
+		auto Load(F&& load) { return m_jobs.Async(std::forward<F>(load), m_pending); }
+
+		//Helps with other loads while waiting; rethrows the exception of a failed load
+		template<typename T>
+		T Get(std::future<T>& result) { return m_jobs.Get(result); }
+
+	private:
+		JobSystem& m_jobs;
+		JobCounter m_pending;
+	};
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+//Splitting of element ranges between scalar code and SIMD kernels working Block elements at a time,
+//for structure-of-arrays data padded to a multiple of Block (used by the silhouette and kinematics batches).
+
+namespace mini
+{
+	//count rounded up to whole blocks, the length of the padded arrays
+	template<size_t Block>
+	constexpr size_t Padded(size_t count)
+	{
+		return (count + Block - 1) / Block * Block;
+	}
+
+	//Splits [first, last) of count elements into a scalar head, whole blocks and a scalar tail.
+	//Padding after the last element is safe to process, so a range ending at count uses whole blocks;
+	//other ranges stay within [first, last), so that ranges may run on different threads.
+	template<size_t Block, typename Scalar, typename Blocks>
+	void SplitRange(size_t first, size_t last, size_t count, Scalar&& scalar, Blocks&& blocks)
+	{
+		size_t begin = Padded<Block>(first);
+		size_t end = last == count ? Padded<Block>(last) : last / Block * Block;
+		if (begin >= end)
+			return scalar(first, last);
+		scalar(first, begin);
+		blocks(begin, end);
+		scalar(end, last);
+	}
+}
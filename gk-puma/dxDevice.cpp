@@ -193,6 +193,21 @@ dx_ptr<ID3D11ShaderResourceView> mini::DxDevice::CreateShaderResourceView(const
 	return resourceView;
 }
 
+dx_ptr<ID3D11ShaderResourceView> mini::DxDevice::CreateShaderResourceView(const std::vector<BYTE>& fileData, const std::wstring& texPath) const
+{
+	ID3D11ShaderResourceView* rv = nullptr;
+	HRESULT hr = 0;
+	const wstring ext{ L".dds" };
+	if (texPath.size() > ext.size() && texPath.compare(texPath.size() - ext.size(), ext.size(), ext) == 0)
+		hr = DirectX::CreateDDSTextureFromMemory(m_device.get(), m_context.get(), fileData.data(), fileData.size(), nullptr, &rv);
+	else
+		hr = DirectX::CreateWICTextureFromMemory(m_device.get(), m_context.get(), fileData.data(), fileData.size(), nullptr, &rv);
+	dx_ptr<ID3D11ShaderResourceView> resourceView(rv);
+	if (FAILED(hr))
+		THROW_DX(hr);
+	return resourceView;
+}
+
 dx_ptr<ID3D11SamplerState> mini::DxDevice::CreateSamplerState(const SamplerDescription& desc) const
 {
 	ID3D11SamplerState* s = nullptr;
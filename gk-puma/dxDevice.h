@@ -81,6 +81,16 @@ namespace mini
 			return CreateBuffer(reinterpret_cast<const void*>(indices.data()), desc);
 		}
 
+		//Dynamic index buffer (no initial data)
+		template<typename T>
+		dx_ptr<ID3D11Buffer> CreateIndexBuffer(unsigned int N) const
+		{
+			auto desc = BufferDescription::IndexBufferDescription(N * sizeof(T));
+			desc.Usage = D3D11_USAGE_DYNAMIC;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			return CreateBuffer(nullptr, desc);
+		}
+
 		template<typename T, size_t N = 1>
 		dx_ptr<ID3D11Buffer> CreateConstantBuffer() const
 		{
@@ -100,6 +110,9 @@ namespace mini
 		//Loading textures from image/dds files using stand-alone DDS/WIC loaders
 		//from DirectXTex texture processing library: https://github.com/microsoft/DirectXTex
 		dx_ptr<ID3D11ShaderResourceView> CreateShaderResourceView(const std::wstring& texPath) const;
+		//Same for a file already read to memory (e.g. with LoadByteCode on a loader thread),
+		//texPath only selects the loader
+		dx_ptr<ID3D11ShaderResourceView> CreateShaderResourceView(const std::vector<BYTE>& fileData, const std::wstring& texPath) const;
 
 		dx_ptr<ID3D11SamplerState> CreateSamplerState(const SamplerDescription& desc) const;
 
@@ -0,0 +1,137 @@
+#include "jobSystem.h"
+#include <algorithm>
+
+using namespace mini;
+using namespace std;
+
+namespace
+{
+	//Job system and queue of the current worker thread
+	thread_local const JobSystem* t_owner = nullptr;
+	thread_local size_t t_queue = 0;
+}
+
+unsigned int JobSystem::DefaultWorkerCount()
+{
+	unsigned int threads = thread::hardware_concurrency();
+	return threads > 1 ? threads - 1 : 1;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	workerCount = max(workerCount, 1u);
+	for (unsigned int i = 0; i <= workerCount; ++i)
+		m_queues.push_back(make_unique<Queue>());
+	m_workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; ++i)
+		m_workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		lock_guard<mutex> lock(m_wakeMutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+size_t JobSystem::CurrentQueue() const
+{
+	return t_owner == this ? t_queue : 0;
+}
+
+void JobSystem::Submit(Job job, JobCounter& counter)
+{
+	counter.pending.fetch_add(1, memory_order_relaxed);
+	size_t queue = CurrentQueue();
+	if (queue == 0)
+		// spread jobs from outside the pool over the workers' queues
+		queue = 1 + m_nextQueue.fetch_add(1, memory_order_relaxed) % m_workers.size();
+	{
+		lock_guard<mutex> lock(m_queues[queue]->mutex);
+		m_queues[queue]->entries.push_back({ move(job), &counter });
+	}
+	{
+		lock_guard<mutex> lock(m_wakeMutex);
+		m_queued.fetch_add(1, memory_order_relaxed);
+	}
+	m_wake.notify_one();
+}
+
+bool JobSystem::TryRunJob(size_t queue)
+{
+	Entry entry;
+	bool found = false;
+	{
+		// own queue - LIFO
+		Queue& own = *m_queues[queue];
+		lock_guard<mutex> lock(own.mutex);
+		if (!own.entries.empty())
+		{
+			entry = move(own.entries.back());
+			own.entries.pop_back();
+			found = true;
+		}
+	}
+	// steal the oldest job from the other queues
+	for (size_t i = 1; !found && i < m_queues.size(); ++i)
+	{
+		Queue& victim = *m_queues[(queue + i) % m_queues.size()];
+		lock_guard<mutex> lock(victim.mutex);
+		if (!victim.entries.empty())
+		{
+			entry = move(victim.entries.front());
+			victim.entries.pop_front();
+			found = true;
+		}
+	}
+	if (!found)
+		return false;
+	m_queued.fetch_sub(1, memory_order_relaxed);
+	try
+	{
+		entry.job();
+	}
+	catch (...)
+	{
+		// keep the exception for Wait, the counter must drop anyway or Wait never returns
+		lock_guard<mutex> lock(entry.counter->errorMutex);
+		if (!entry.counter->error)
+			entry.counter->error = current_exception();
+	}
+	entry.counter->pending.fetch_sub(1, memory_order_acq_rel);
+	return true;
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const size_t queue = CurrentQueue();
+	while (counter.pending.load(memory_order_acquire) > 0)
+		if (!TryRunJob(queue))
+			this_thread::yield();
+	exception_ptr error;
+	{
+		lock_guard<mutex> lock(counter.errorMutex);
+		swap(error, counter.error);
+	}
+	if (error)
+		rethrow_exception(error);
+}
+
+void JobSystem::WorkerLoop(size_t queue)
+{
+	t_owner = this;
+	t_queue = queue;
+	for (;;)
+	{
+		if (TryRunJob(queue))
+			continue;
+		unique_lock<mutex> lock(m_wakeMutex);
+		m_wake.wait(lock, [this] { return m_stop || m_queued.load(memory_order_relaxed) > 0; });
+		if (m_stop)
+			return;
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//Fixed-size pool of worker threads. Every worker owns a job queue, takes
+//jobs from its back and steals from the front of other queues when empty.
+
+namespace mini
+{
+	//Number of jobs submitted with it and not finished yet
+	struct JobCounter
+	{
+		std::atomic<size_t> pending{ 0 };
+		//First exception thrown by its jobs, rethrown by JobSystem::Wait
+		std::mutex errorMutex;
+		std::exception_ptr error;
+	};
+
+	class JobSystem
+	{
+	public:
+		using Job = std::function<void()>;
+
+		//One worker less than hardware threads, the waiting thread runs jobs too
+		static unsigned int DefaultWorkerCount();
+
+		explicit JobSystem(unsigned int workerCount = DefaultWorkerCount());
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		~JobSystem();
+
+		unsigned int WorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+		//Jobs may submit further jobs. Called from a worker, the job goes to its own queue.
+		void Submit(Job job, JobCounter& counter);
+		//Runs queued jobs on the calling thread until the counter drops to zero,
+		//then rethrows the first exception thrown by the counter's jobs
+		void Wait(JobCounter& counter);
+
+		//Calls f(i) for i in [0, count) and waits for all of them, rethrows the first exception
+		template<typename F>
+		void ParallelFor(size_t count, F&& f)
+		{
+			JobCounter counter;
+			for (size_t i = 0; i < count; ++i)
+				Submit([&f, i] { f(i); }, counter);
+			Wait(counter);
+		}
+
+		//Runs f() as a job and returns a future of its result (or exception).
+		//The counter must not be destroyed before the job finishes.
+		template<typename F>
+		auto Async(F&& f, JobCounter& counter) -> std::future<std::invoke_result_t<std::decay_t<F>&>>
+		{
+			using Result = std::invoke_result_t<std::decay_t<F>&>;
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+			auto result = task->get_future();
+			Submit([task] { (*task)(); }, counter);
+			return result;
+		}
+
+		//Runs queued jobs on the calling thread until the future is ready and returns its result
+		template<typename T>
+		T Get(std::future<T>& future)
+		{
+			const size_t queue = CurrentQueue();
+			while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				if (!TryRunJob(queue))
+					std::this_thread::yield();
+			return future.get();
+		}
+
+	private:
+		struct Entry
+		{
+			Job job;
+			JobCounter* counter;
+		};
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Entry> entries;
+		};
+
+		//Queue 0 is fed by threads outside the pool, queue i + 1 belongs to worker i
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread> m_workers;
+		std::atomic<size_t> m_queued{ 0 };
+		std::atomic<size_t> m_nextQueue{ 0 };
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wake;
+		bool m_stop = false;
+
+		size_t CurrentQueue() const;
+		bool TryRunJob(size_t queue);
+		void WorkerLoop(size_t queue);
+	};
+}
@@ -1,21 +1,24 @@
 #include "mesh.h"
 #include <algorithm>
-#include <fstream>
+#include <filesystem>
+#include "meshFile.h"
+#include "vertexCache.h"
 
 using namespace std;
 using namespace mini;
 using namespace DirectX;
 
 Mesh::Mesh()
-	: m_indexCount(0), m_primitiveType(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED)
+	: m_indexCount(0), m_primitiveType(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED), m_indexFormat(DXGI_FORMAT_R16_UINT)
 { }
 
 Mesh::Mesh(dx_ptr_vector<ID3D11Buffer>&& vbuffers, vector<unsigned int>&& vstrides, vector<unsigned int>&& voffsets,
-	dx_ptr<ID3D11Buffer>&& indices, unsigned int indexCount, D3D_PRIMITIVE_TOPOLOGY primitiveType)
+	dx_ptr<ID3D11Buffer>&& indices, unsigned int indexCount, D3D_PRIMITIVE_TOPOLOGY primitiveType, DXGI_FORMAT indexFormat)
 {
 	assert(vbuffers.size() == voffsets.size() && vbuffers.size() == vstrides.size());
 	m_indexCount = indexCount;
 	m_primitiveType = primitiveType;
+	m_indexFormat = indexFormat;
 	m_indexBuffer = move(indices);
 
 	m_vertexBuffers = std::move(vbuffers);
@@ -26,7 +29,7 @@ Mesh::Mesh(dx_ptr_vector<ID3D11Buffer>&& vbuffers, vector<unsigned int>&& vstrid
 Mesh::Mesh(Mesh&& right) noexcept
 	: m_indexBuffer(move(right.m_indexBuffer)), m_vertexBuffers(move(right.m_vertexBuffers)),
 	m_strides(move(right.m_strides)), m_offsets(move(right.m_offsets)),
-	m_indexCount(right.m_indexCount), m_primitiveType(right.m_primitiveType)
+	m_indexCount(right.m_indexCount), m_primitiveType(right.m_primitiveType), m_indexFormat(right.m_indexFormat)
 {
 	right.Release();
 }
@@ -50,6 +53,7 @@ Mesh& Mesh::operator=(Mesh&& right) noexcept
 	m_offsets = move(right.m_offsets);
 	m_indexCount = right.m_indexCount;
 	m_primitiveType = right.m_primitiveType;
+	m_indexFormat = right.m_indexFormat;
 	right.Release();
 	return *this;
 }
@@ -59,11 +63,22 @@ void Mesh::Render(const dx_ptr<ID3D11DeviceContext>& context) const
 	if (!m_indexBuffer || m_vertexBuffers.empty())
 		return;
 	context->IASetPrimitiveTopology(m_primitiveType);
-	context->IASetIndexBuffer(m_indexBuffer.get(), DXGI_FORMAT_R16_UINT, 0);
+	context->IASetIndexBuffer(m_indexBuffer.get(), m_indexFormat, 0);
 	context->IASetVertexBuffers(0, m_vertexBuffers.size(), m_vertexBuffers.data(), m_strides.data(), m_offsets.data());
 	context->DrawIndexed(m_indexCount, 0, 0);
 }
 
+void Mesh::Render(const dx_ptr<ID3D11DeviceContext>& context, const std::vector<IndexRange>& ranges) const
+{
+	if (!m_indexBuffer || m_vertexBuffers.empty() || ranges.empty())
+		return;
+	context->IASetPrimitiveTopology(m_primitiveType);
+	context->IASetIndexBuffer(m_indexBuffer.get(), m_indexFormat, 0);
+	context->IASetVertexBuffers(0, m_vertexBuffers.size(), m_vertexBuffers.data(), m_strides.data(), m_offsets.data());
+	for (const IndexRange& range : ranges)
+		context->DrawIndexed(range.count, range.start, 0);
+}
+
 Mesh::~Mesh()
 {
 	Release();
@@ -453,47 +468,34 @@ std::vector<unsigned short> mini::Mesh::DiskIdx(unsigned int slices)
 	return indices;
 }
 
-Mesh mini::Mesh::LoadMesh(const DxDevice& device, const std::wstring& meshPath)
+Mesh mini::Mesh::LoadMesh(const DxDevice& device, const std::wstring& meshPath, bool optimizeVertexOrder)
 {
-	//File format for VN vertices and IN indices (IN divisible by 3, i.e. IN/3 triangles):
-	//VN IN
-	//pos.x pos.y pos.z norm.x norm.y norm.z tex.x tex.y [VN times, i.e. for each vertex]
-	//t.i1 t.i2 t.i3 [IN/3 times, i.e. for each triangle]
-
-	ifstream input;
-	// In general we shouldn't throw exceptions on end-of-file,
-	// however, in case of this file format if we reach the end
-	// of a file before we read all values, the file is
-	// ill-formated and we would need to throw an exception anyway
-	input.exceptions(ios::badbit | ios::failbit | ios::eofbit);
-	input.open(meshPath);
-
-	int k, l, m, n;
-	input >> k;
-	vector<XMFLOAT3> positions(k);
-	for (int i = 0; i < k; ++i)
-		input >> positions[i].x >> positions[i].y >> positions[i].z;
-
-	input >> l;
-	vector<VertexPositionNormal> vertices(l);
-	for (int i = 0; i < l; ++i) {
-		int posIndex;
-		XMFLOAT3 normal;
-		input >> posIndex >> normal.x >> normal.y >> normal.z;
-		vertices[i].position = positions[posIndex];
-		vertices[i].normal = normal;
+	// .mesh - wierzcholki z teksturami i lista trojkatow, pozostale - format mesh*.txt (krawedzie pomijane)
+	filesystem::path path = meshPath;
+	vector<VertexPositionNormal> vertices;
+	vector<unsigned int> indices;
+	if (path.extension() == ".mesh")
+	{
+		IndexedMeshData data = LoadIndexedTextMesh(path);
+		vertices.reserve(data.positions.size());
+		for (size_t i = 0; i < data.positions.size(); ++i)
+			vertices.emplace_back(data.positions[i], data.normals[i]);
+		indices = move(data.indices);
 	}
-
-	input >> m;
-	vector<unsigned short> indices(m * 3);
-	for (int i = 0; i < m * 3; ++i)
-		input >> indices[i];
-
-	input >> n;
-	// KRAWEDZIE
-	//getline(input, skipLine); 
-	//for (int i = 0; i < n; ++i)
-	//	getline(input, skipLine);
-	input.close();
-	return SimpleTriMesh(device, vertices, indices);
+	else
+	{
+		MeshData data = LoadTextMesh(path);
+		vertices.reserve(data.vertexPositions.size());
+		for (size_t i = 0; i < data.vertexPositions.size(); ++i)
+			vertices.emplace_back(data.positions[data.vertexPositions[i]], data.normals[i]);
+		indices.reserve(3 * data.faces.size());
+		for (const auto& face : data.faces)
+			indices.insert(indices.end(), begin(face.indices), end(face.indices));
+	}
+	if (optimizeVertexOrder)
+	{
+		OptimizeVertexCache(indices, vertices.size());
+		RemapVertices(vertices, OptimizeVertexFetch(indices, vertices.size()));
+	}
+	return IndexedTriMesh(device, vertices, indices);
 }
@@ -2,6 +2,9 @@
 
 #include "dxptr.h"
 #include <vector>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 #include <DirectXMath.h>
 #include <D3D11.h>
 #include "vertexTypes.h"
@@ -17,16 +20,18 @@ namespace mini
 			std::vector<unsigned int>&& vstrides,
 			dx_ptr<ID3D11Buffer>&& indices,
 			unsigned int indexCount,
-			D3D_PRIMITIVE_TOPOLOGY primitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+			D3D_PRIMITIVE_TOPOLOGY primitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST,
+			DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT)
 			: Mesh(std::move(vbuffers), std::move(vstrides), std::vector<unsigned>(vbuffers.size(), 0U),
-				std::move(indices), indexCount, primitiveType)
+				std::move(indices), indexCount, primitiveType, indexFormat)
 		{ }
 		Mesh(dx_ptr_vector<ID3D11Buffer>&& vbuffers,
 			std::vector<unsigned int>&& vstrides,
 			std::vector<unsigned int>&& voffsets,
 			dx_ptr<ID3D11Buffer>&& indices,
 			unsigned int indexCount,
-			D3D_PRIMITIVE_TOPOLOGY primitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			D3D_PRIMITIVE_TOPOLOGY primitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST,
+			DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT);
 
 		Mesh(Mesh&& right) noexcept;
 		Mesh(const Mesh& right) = delete;
@@ -37,8 +42,27 @@ namespace mini
 		Mesh& operator=(Mesh&& right) noexcept;
 		void Render(const dx_ptr<ID3D11DeviceContext>& context) const;
 
-		template<typename VertexType>
-		static Mesh SimpleTriMesh(const DxDevice& device, const std::vector<VertexType> verts, const std::vector<unsigned short> idxs)
+		struct IndexRange
+		{
+			unsigned int start, count;
+		};
+		//Draws only the given ranges of the index buffer
+		void Render(const dx_ptr<ID3D11DeviceContext>& context, const std::vector<IndexRange>& ranges) const;
+
+		//Index buffer format matching the index type (16 or 32 bit)
+		template<typename IndexType>
+		static constexpr DXGI_FORMAT IndexFormat()
+		{
+			static_assert(std::is_same_v<IndexType, unsigned short> || std::is_same_v<IndexType, unsigned int>,
+				"Index buffers hold 16 or 32-bit unsigned integers");
+			return sizeof(IndexType) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		}
+
+		//Whether vertexCount vertices can be addressed with 16-bit indices
+		static bool FitsShortIndices(size_t vertexCount) { return vertexCount <= std::numeric_limits<unsigned short>::max() + size_t(1); }
+
+		template<typename VertexType, typename IndexType = unsigned short>
+		static Mesh SimpleTriMesh(const DxDevice& device, const std::vector<VertexType>& verts, const std::vector<IndexType>& idxs)
 		{
 			if (idxs.empty())
 				return {};
@@ -47,11 +71,25 @@ namespace mini
 			result.m_vertexBuffers.push_back(device.CreateVertexBuffer(verts));
 			result.m_strides.push_back(sizeof(VertexType));
 			result.m_offsets.push_back(0);
-			result.m_indexCount = idxs.size();
+			result.m_indexCount = static_cast<unsigned int>(idxs.size());
 			result.m_primitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+			result.m_indexFormat = IndexFormat<IndexType>();
 			return result;
 		}
 
+		//Picks 16-bit indices when all vertices can be addressed with them, 32-bit otherwise.
+		//Throws std::out_of_range if an index does not refer to a vertex.
+		template<typename VertexType>
+		static Mesh IndexedTriMesh(const DxDevice& device, const std::vector<VertexType>& verts, const std::vector<unsigned int>& idxs)
+		{
+			for (auto i : idxs)
+				if (i >= verts.size())
+					throw std::out_of_range("Mesh index out of range");
+			if (!FitsShortIndices(verts.size()))
+				return SimpleTriMesh(device, verts, idxs);
+			return SimpleTriMesh(device, verts, std::vector<unsigned short>(idxs.begin(), idxs.end()));
+		}
+
 		//Box Mesh Creation
 
 		static std::vector<VertexPositionColor> ColoredBoxVerts(float width, float height, float depth);
@@ -107,7 +145,7 @@ namespace mini
 		static Mesh Disk(const DxDevice& device, unsigned int slices, float radius = 1.0f) { return SimpleTriMesh(device, DiskVerts(slices, radius), DiskIdx(slices)); }
 
 		//Mesh Loading
-		static Mesh LoadMesh(const DxDevice& device, const std::wstring& meshPath);
+		static Mesh LoadMesh(const DxDevice& device, const std::wstring& meshPath, bool optimizeVertexOrder = false);
 
 	private:
 		dx_ptr<ID3D11Buffer> m_indexBuffer;
@@ -116,5 +154,6 @@ namespace mini
 		std::vector<unsigned int> m_offsets;
 		unsigned int m_indexCount;
 		D3D_PRIMITIVE_TOPOLOGY m_primitiveType;
+		DXGI_FORMAT m_indexFormat;
 	};
 }
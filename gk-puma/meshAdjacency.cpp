@@ -0,0 +1,253 @@
+#include "meshAdjacency.h"
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	uint64_t Mix(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		return h ^ (h >> 33);
+	}
+
+	//Open addressing (linear probing) table of indices into an external array,
+	//without removal. Capacity keeps the load factor at most 1/2.
+	class IndexTable
+	{
+	public:
+		static constexpr uint32_t Empty = UINT32_MAX;
+
+		explicit IndexTable(size_t count)
+		{
+			size_t capacity = 16;
+			while (capacity < 2 * count)
+				capacity *= 2;
+			m_slots.assign(capacity, Empty);
+			m_mask = capacity - 1;
+		}
+
+		//Slot holding an index for which equal(index) is true, or the empty slot where it belongs
+		template<typename Equal>
+		uint32_t& Find(uint64_t hash, Equal&& equal)
+		{
+			for (size_t i = Mix(hash) & m_mask;; i = (i + 1) & m_mask)
+				if (m_slots[i] == Empty || equal(m_slots[i]))
+					return m_slots[i];
+		}
+
+	private:
+		vector<uint32_t> m_slots;
+		size_t m_mask;
+	};
+
+	uint32_t Bits(float f)
+	{
+		// -0 i +0 to ta sama pozycja
+		if (f == 0.f)
+			f = 0.f;
+		uint32_t bits;
+		memcpy(&bits, &f, sizeof(bits));
+		return bits;
+	}
+
+	uint64_t PositionHash(const XMFLOAT3& p)
+	{
+		return Mix((uint64_t(Bits(p.x)) << 32) | Bits(p.y)) ^ Bits(p.z);
+	}
+
+	bool SamePosition(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	struct Cell
+	{
+		int32_t x, y, z;
+		bool operator==(const Cell& c) const { return x == c.x && y == c.y && z == c.z; }
+	};
+
+	uint64_t CellHash(const Cell& c)
+	{
+		return Mix((uint64_t(uint32_t(c.x)) << 32) | uint32_t(c.y)) ^ uint32_t(c.z);
+	}
+
+	uint32_t Find(vector<uint32_t>& parent, uint32_t i)
+	{
+		while (parent[i] != i)
+			i = parent[i] = parent[parent[i]];
+		return i;
+	}
+}
+
+WeldedPositions mini::WeldPositions(const vector<XMFLOAT3>& vertices, float tolerance)
+{
+	WeldedPositions result;
+	result.vertexPositions.resize(vertices.size());
+	IndexTable table(vertices.size());
+	if (tolerance <= 0.f)
+	{
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const XMFLOAT3& v = vertices[i];
+			uint32_t& slot = table.Find(PositionHash(v), [&](uint32_t p) { return SamePosition(result.positions[p], v); });
+			if (slot == IndexTable::Empty)
+			{
+				slot = static_cast<uint32_t>(result.positions.size());
+				result.positions.push_back(v);
+			}
+			result.vertexPositions[i] = slot;
+		}
+		return result;
+	}
+
+	// siatka komorek o boku tolerance - sasiad w odleglosci tolerance lezy w jednej z 27 komorek;
+	// tablica wskazuje pierwsza pozycje komorki, kolejne sa na liscie next
+	auto cellOf = [tolerance](const XMFLOAT3& p)
+	{
+		return Cell{ static_cast<int32_t>(floorf(p.x / tolerance)), static_cast<int32_t>(floorf(p.y / tolerance)),
+			static_cast<int32_t>(floorf(p.z / tolerance)) };
+	};
+	vector<uint32_t> next;
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		const XMFLOAT3& v = vertices[i];
+		const Cell cell = cellOf(v);
+		uint32_t found = IndexTable::Empty;
+		for (int dx = -1; dx <= 1 && found == IndexTable::Empty; ++dx)
+			for (int dy = -1; dy <= 1 && found == IndexTable::Empty; ++dy)
+				for (int dz = -1; dz <= 1 && found == IndexTable::Empty; ++dz)
+				{
+					Cell c{ cell.x + dx, cell.y + dy, cell.z + dz };
+					uint32_t head = table.Find(CellHash(c), [&](uint32_t p) { return cellOf(result.positions[p]) == c; });
+					for (uint32_t p = head; p != IndexTable::Empty; p = next[p])
+					{
+						const XMFLOAT3& q = result.positions[p];
+						if (fabsf(q.x - v.x) <= tolerance && fabsf(q.y - v.y) <= tolerance && fabsf(q.z - v.z) <= tolerance)
+						{
+							found = p;
+							break;
+						}
+					}
+				}
+		if (found == IndexTable::Empty)
+		{
+			found = static_cast<uint32_t>(result.positions.size());
+			uint32_t& head = table.Find(CellHash(cell), [&](uint32_t p) { return cellOf(result.positions[p]) == cell; });
+			next.push_back(head);
+			head = found;
+			result.positions.push_back(v);
+		}
+		result.vertexPositions[i] = found;
+	}
+	return result;
+}
+
+vector<uint32_t> mini::MatchPositions(const vector<XMFLOAT3>& positions, const vector<XMFLOAT3>& vertices)
+{
+	IndexTable table(positions.size());
+	for (uint32_t i = 0; i < positions.size(); ++i)
+	{
+		uint32_t& slot = table.Find(PositionHash(positions[i]), [&](uint32_t p) { return SamePosition(positions[p], positions[i]); });
+		// powtorzona pozycja - wierzcholki dostaja pierwsza
+		if (slot == IndexTable::Empty)
+			slot = i;
+	}
+	vector<uint32_t> result(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		result[i] = table.Find(PositionHash(vertices[i]), [&](uint32_t p) { return SamePosition(positions[p], vertices[i]); });
+	return result;
+}
+
+vector<Edge> mini::BuildEdges(const vector<Face>& faces, const vector<uint32_t>& vertexPositions, AdjacencyStats* stats)
+{
+	vector<Edge> edges;
+	edges.reserve(faces.size() * 3 / 2);
+	// zamknieta siatka ma 3/2 krawedzi na sciane; pojemnosc > 3 * liczba scian, wiec
+	// miesci tez siatke bez zadnego sasiedztwa
+	IndexTable table(faces.size() * 3 / 2 + 1);
+	size_t nonManifold = 0;
+	for (uint32_t f = 0; f < faces.size(); ++f)
+	{
+		const uint32_t p[3] = { vertexPositions[faces[f].indices[0]], vertexPositions[faces[f].indices[1]],
+			vertexPositions[faces[f].indices[2]] };
+		// sciana zdegenerowana (zespawane wierzcholki) jest pomijana - sasiedzi lacza sie ponad nia
+		if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0])
+			continue;
+		for (int i = 0; i < 3; ++i)
+		{
+			uint32_t a = p[i], b = p[(i + 1) % 3];
+			if (a > b)
+				swap(a, b);
+			uint32_t& slot = table.Find((uint64_t(a) << 32) | b, [&](uint32_t e) { return edges[e].v0 == a && edges[e].v1 == b; });
+			if (slot != IndexTable::Empty && edges[slot].face1 == UINT_MAX)
+			{
+				edges[slot].face1 = f;
+				continue;
+			}
+			// nowa krawedz; trzecia sciana przy pelnej krawedzi zaczyna kolejna pare
+			if (slot != IndexTable::Empty)
+				++nonManifold;
+			slot = static_cast<uint32_t>(edges.size());
+			edges.emplace_back(a, b, f, UINT_MAX);
+		}
+	}
+	if (stats)
+	{
+		stats->nonManifoldEdges = nonManifold;
+		stats->boundaryEdges = 0;
+		for (const Edge& e : edges)
+			stats->boundaryEdges += e.face1 == UINT_MAX;
+	}
+	return edges;
+}
+
+size_t mini::CloseBoundaries(vector<Face>& faces, vector<Edge>& edges)
+{
+	// spojne fragmenty siatki (union-find po krawedziach), fragmenty z otwartymi krawedziami sa podwajane
+	const uint32_t faceCount = static_cast<uint32_t>(faces.size());
+	vector<uint32_t> parent(faceCount);
+	iota(parent.begin(), parent.end(), 0u);
+	bool anyOpen = false;
+	for (const Edge& e : edges)
+		if (e.face1 == UINT_MAX)
+			anyOpen = true;
+		else
+			parent[Find(parent, e.face0)] = Find(parent, e.face1);
+	if (!anyOpen)
+		return 0;
+
+	vector<uint8_t> open(faceCount, 0);
+	for (const Edge& e : edges)
+		if (e.face1 == UINT_MAX)
+			open[Find(parent, e.face0)] = 1;
+
+	vector<uint32_t> reversed(faceCount, UINT_MAX);
+	for (uint32_t f = 0; f < faceCount; ++f)
+		if (open[Find(parent, f)])
+		{
+			reversed[f] = static_cast<uint32_t>(faces.size());
+			const Face& face = faces[f];
+			faces.emplace_back(face.indices[0], face.indices[2], face.indices[1]);
+		}
+
+	const size_t edgeCount = edges.size();
+	for (size_t i = 0; i < edgeCount; ++i)
+	{
+		Edge& e = edges[i];
+		if (reversed[e.face0] == UINT_MAX)
+			continue;
+		if (e.face1 == UINT_MAX)
+			e.face1 = reversed[e.face0];
+		else
+			edges.emplace_back(e.v0, e.v1, reversed[e.face0], reversed[e.face1]);
+	}
+	return faces.size() - faceCount;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "silhouette.h"
+
+//Adjacency reconstruction for shadow casters: vertex welding and edge building
+//with open-addressing hash tables, in expected linear time.
+
+namespace mini
+{
+	//Unique positions of a set of vertices
+	struct WeldedPositions
+	{
+		std::vector<DirectX::XMFLOAT3> positions;
+		//Position of each vertex
+		std::vector<uint32_t> vertexPositions;
+	};
+
+	//Merges vertices whose coordinates differ by at most tolerance (exact match for 0).
+	//Positions are the first vertex of each group, in order of appearance.
+	WeldedPositions WeldPositions(const std::vector<DirectX::XMFLOAT3>& vertices, float tolerance = 0.f);
+
+	//Index of the position with exactly the same coordinates as each vertex, UINT32_MAX if none
+	std::vector<uint32_t> MatchPositions(const std::vector<DirectX::XMFLOAT3>& positions,
+		const std::vector<DirectX::XMFLOAT3>& vertices);
+
+	struct AdjacencyStats
+	{
+		//Edges with one face (face1 == UINT_MAX) before CloseBoundaries
+		size_t boundaryEdges = 0;
+		//Extra edges created for edges shared by more than two faces
+		size_t nonManifoldEdges = 0;
+		//Reversed faces added by CloseBoundaries
+		size_t closingFaces = 0;
+	};
+
+	//Edges of faces (indexing vertices) between positions given by vertexPositions.
+	//Faces of an edge shared by more than two faces are paired in order of appearance.
+	//Degenerate faces (two vertices at one position) get no edges.
+	std::vector<Edge> BuildEdges(const std::vector<Face>& faces, const std::vector<uint32_t>& vertexPositions,
+		AdjacencyStats* stats = nullptr);
+
+	//Makes every connected part of the mesh that has open edges two-sided: appends its faces
+	//with reversed winding and their edges, and joins each open edge with the reversed copy
+	//of its face. Afterwards no edge has face1 == UINT_MAX and shadow volumes are closed.
+	//Returns the number of faces added.
+	size_t CloseBoundaries(std::vector<Face>& faces, std::vector<Edge>& edges);
+}
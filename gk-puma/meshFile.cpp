@@ -0,0 +1,372 @@
+#include "meshFile.h"
+#include "textParser.h"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+static_assert(sizeof(XMFLOAT3) == 12 && sizeof(Face) == 12 && sizeof(Edge) == 16, "Binary mesh arrays are stored as is");
+static_assert(is_trivially_copyable_v<Face> && is_trivially_copyable_v<Edge>, "Binary mesh arrays are stored as is");
+
+MeshView::MeshView(const MeshData& data)
+	: positions{ data.positions.data(), data.positions.size() },
+	vertexPositions{ data.vertexPositions.data(), data.vertexPositions.size() },
+	normals{ data.normals.data(), data.normals.size() },
+	faces{ data.faces.data(), data.faces.size() },
+	edges{ data.edges.data(), data.edges.size() }
+{
+}
+
+MeshData MeshView::ToMeshData() const
+{
+	MeshData data;
+	data.positions.assign(positions.begin(), positions.end());
+	data.vertexPositions.assign(vertexPositions.begin(), vertexPositions.end());
+	data.normals.assign(normals.begin(), normals.end());
+	data.faces.assign(faces.begin(), faces.end());
+	data.edges.assign(edges.begin(), edges.end());
+	return data;
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const filesystem::path& path)
+{
+	m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		m_file = nullptr;
+		throw runtime_error("Cannot open " + path.string());
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(m_file, &size);
+	m_size = static_cast<size_t>(size.QuadPart);
+	if (m_size == 0)
+		return;
+	m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping)
+		m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data)
+	{
+		close();
+		throw runtime_error("Cannot map " + path.string());
+	}
+}
+
+void MappedFile::close()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+	m_data = nullptr;
+	m_mapping = m_file = nullptr;
+	m_size = 0;
+}
+#else
+MappedFile::MappedFile(const filesystem::path& path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw runtime_error("Cannot open " + path.string());
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		m_size = static_cast<size_t>(info.st_size);
+		// pliki sa czytane w calosci - strony wczytywane od razu, bez bledow stron przy parsowaniu
+#ifdef MAP_POPULATE
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+#else
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+		if (data != MAP_FAILED)
+			m_data = static_cast<const std::byte*>(data);
+	}
+	::close(fd);
+	if (m_size && !m_data)
+		throw runtime_error("Cannot map " + path.string());
+}
+
+void MappedFile::close()
+{
+	if (m_data)
+		munmap(const_cast<std::byte*>(m_data), m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		close();
+		swap(m_data, other.m_data);
+		swap(m_size, other.m_size);
+#ifdef _WIN32
+		swap(m_file, other.m_file);
+		swap(m_mapping, other.m_mapping);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+namespace
+{
+	// indeksy musza wskazywac istniejace elementy - dalej uzywane bez sprawdzania
+	void Validate(const MeshView& mesh)
+	{
+		if (mesh.normals.size != mesh.vertexPositions.size)
+			throw runtime_error("Mesh vertex arrays differ in size");
+		for (uint32_t p : mesh.vertexPositions)
+			if (p >= mesh.positions.size)
+				throw runtime_error("Mesh vertex position index out of range");
+		for (const Face& f : mesh.faces)
+			for (unsigned v : f.indices)
+				if (v >= mesh.vertexPositions.size)
+					throw runtime_error("Mesh face index out of range");
+		for (const Edge& e : mesh.edges)
+			if (e.v0 >= mesh.positions.size || e.v1 >= mesh.positions.size || e.face0 >= mesh.faces.size
+				|| (e.face1 >= mesh.faces.size && e.face1 != UINT_MAX))
+				throw runtime_error("Mesh edge index out of range");
+	}
+
+	template<typename T>
+	ArrayView<T> Section(const MappedFile& file, uint64_t offset, uint32_t count)
+	{
+		if (offset % BinaryMeshAlignment != 0 || offset > file.size() || (file.size() - offset) / sizeof(T) < count)
+			throw runtime_error("Binary mesh section out of file bounds");
+		return { reinterpret_cast<const T*>(file.data() + offset), count };
+	}
+
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + BinaryMeshAlignment - 1) / BinaryMeshAlignment * BinaryMeshAlignment;
+	}
+}
+
+MeshData mini::LoadTextMesh(const filesystem::path& path)
+{
+	//File format:
+	//PN, then pos.x pos.y pos.z [PN times]
+	//VN, then posIndex norm.x norm.y norm.z [VN times]
+	//FN, then v0 v1 v2 [FN times]
+	//EN, then p0 p1 face0 face1 [EN times]
+	MappedFile file(path);
+	const string source = path.string();
+	const char* text = reinterpret_cast<const char*>(file.data());
+	TextParser parser(text, text + file.size(), source);
+
+	MeshData mesh;
+	mesh.positions.resize(parser.ReadCount(3));
+	for (auto& p : mesh.positions)
+		p = { parser.ReadFloat(), parser.ReadFloat(), parser.ReadFloat() };
+
+	size_t n = parser.ReadCount(4);
+	mesh.vertexPositions.resize(n);
+	mesh.normals.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		mesh.vertexPositions[i] = parser.ReadUnsigned();
+		mesh.normals[i] = { parser.ReadFloat(), parser.ReadFloat(), parser.ReadFloat() };
+	}
+
+	mesh.faces.resize(parser.ReadCount(3));
+	for (auto& f : mesh.faces)
+		for (auto& index : f.indices)
+			index = parser.ReadUnsigned();
+
+	mesh.edges.resize(parser.ReadCount(4));
+	for (auto& e : mesh.edges)
+	{
+		e.v0 = parser.ReadUnsigned();
+		e.v1 = parser.ReadUnsigned();
+		e.face0 = parser.ReadUnsigned();
+		e.face1 = parser.ReadUnsigned();
+	}
+	parser.ExpectEnd();
+	Validate(MeshView(mesh));
+	return mesh;
+}
+
+IndexedMeshData mini::LoadIndexedTextMesh(const filesystem::path& path)
+{
+	//File format for VN vertices and IN indices (IN divisible by 3, i.e. IN/3 triangles):
+	//VN IN
+	//pos.x pos.y pos.z norm.x norm.y norm.z tex.x tex.y [VN times, i.e. for each vertex]
+	//t.i1 t.i2 t.i3 [IN/3 times, i.e. for each triangle]
+	MappedFile file(path);
+	const string source = path.string();
+	const char* text = reinterpret_cast<const char*>(file.data());
+	TextParser parser(text, text + file.size(), source);
+
+	IndexedMeshData mesh;
+	size_t vertexCount = parser.ReadCount(8);
+	size_t indexCount = parser.ReadCount(0);
+	mesh.positions.resize(vertexCount);
+	mesh.normals.resize(vertexCount);
+	mesh.texCoords.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		mesh.positions[i] = { parser.ReadFloat(), parser.ReadFloat(), parser.ReadFloat() };
+		mesh.normals[i] = { parser.ReadFloat(), parser.ReadFloat(), parser.ReadFloat() };
+		mesh.texCoords[i] = { parser.ReadFloat(), parser.ReadFloat() };
+	}
+	if (indexCount % 3 != 0)
+		throw runtime_error(source + ": index count not divisible by 3");
+	mesh.indices.resize(indexCount);
+	for (auto& index : mesh.indices)
+	{
+		index = parser.ReadUnsigned();
+		if (index >= vertexCount)
+			throw TextParseError(source, parser.Line(), parser.Column(), "vertex index out of range");
+	}
+	parser.ExpectEnd();
+	return mesh;
+}
+
+void mini::SaveTextMesh(const MeshView& mesh, const filesystem::path& path)
+{
+	// najkrotszy zapis, ktory wczytuje sie do tej samej wartosci
+	string text;
+	char buffer[32];
+	auto put = [&](auto value, char separator)
+	{
+		text.append(buffer, to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+		text += separator;
+	};
+	put(mesh.positions.size, '\n');
+	for (const auto& p : mesh.positions)
+	{
+		put(p.x, ' ');
+		put(p.y, ' ');
+		put(p.z, '\n');
+	}
+	put(mesh.vertexPositions.size, '\n');
+	for (size_t i = 0; i < mesh.vertexPositions.size; ++i)
+	{
+		put(mesh.vertexPositions[i], ' ');
+		put(mesh.normals[i].x, ' ');
+		put(mesh.normals[i].y, ' ');
+		put(mesh.normals[i].z, '\n');
+	}
+	put(mesh.faces.size, '\n');
+	for (const auto& f : mesh.faces)
+	{
+		put(f.indices[0], ' ');
+		put(f.indices[1], ' ');
+		put(f.indices[2], '\n');
+	}
+	put(mesh.edges.size, '\n');
+	for (const auto& e : mesh.edges)
+	{
+		put(e.v0, ' ');
+		put(e.v1, ' ');
+		put(e.face0, ' ');
+		put(e.face1, '\n');
+	}
+	ofstream output(path, ios::binary);
+	output.write(text.data(), static_cast<streamsize>(text.size()));
+	if (!output)
+		throw runtime_error("Cannot write " + path.string());
+}
+
+void mini::SaveBinaryMesh(const MeshView& mesh, const filesystem::path& path)
+{
+	BinaryMeshHeader header = {};
+	header.magic = BinaryMeshHeader::Magic;
+	header.version = BinaryMeshHeader::CurrentVersion;
+	header.positionCount = static_cast<uint32_t>(mesh.positions.size);
+	header.vertexCount = static_cast<uint32_t>(mesh.vertexPositions.size);
+	header.faceCount = static_cast<uint32_t>(mesh.faces.size);
+	header.edgeCount = static_cast<uint32_t>(mesh.edges.size);
+	uint64_t offset = sizeof(BinaryMeshHeader);
+	auto place = [&offset](uint64_t& sectionOffset, size_t bytes)
+	{
+		sectionOffset = offset = AlignOffset(offset);
+		offset += bytes;
+	};
+	place(header.positionsOffset, mesh.positions.size * sizeof(XMFLOAT3));
+	place(header.vertexPositionsOffset, mesh.vertexPositions.size * sizeof(uint32_t));
+	place(header.normalsOffset, mesh.normals.size * sizeof(XMFLOAT3));
+	place(header.facesOffset, mesh.faces.size * sizeof(Face));
+	place(header.edgesOffset, mesh.edges.size * sizeof(Edge));
+	header.fileSize = offset;
+
+	vector<std::byte> buffer(header.fileSize);
+	auto write = [&buffer](uint64_t sectionOffset, const void* data, size_t bytes)
+	{
+		if (bytes)
+			memcpy(buffer.data() + sectionOffset, data, bytes);
+	};
+	write(0, &header, sizeof(header));
+	write(header.positionsOffset, mesh.positions.data, mesh.positions.size * sizeof(XMFLOAT3));
+	write(header.vertexPositionsOffset, mesh.vertexPositions.data, mesh.vertexPositions.size * sizeof(uint32_t));
+	write(header.normalsOffset, mesh.normals.data, mesh.normals.size * sizeof(XMFLOAT3));
+	write(header.facesOffset, mesh.faces.data, mesh.faces.size * sizeof(Face));
+	write(header.edgesOffset, mesh.edges.data, mesh.edges.size * sizeof(Edge));
+
+	ofstream output(path, ios::binary);
+	output.write(reinterpret_cast<const char*>(buffer.data()), static_cast<streamsize>(buffer.size()));
+	if (!output)
+		throw runtime_error("Cannot write " + path.string());
+}
+
+MeshView mini::ViewBinaryMesh(const MappedFile& file)
+{
+	if (file.size() < sizeof(BinaryMeshHeader))
+		throw runtime_error("Binary mesh file too short");
+	BinaryMeshHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != BinaryMeshHeader::Magic)
+		throw runtime_error("Not a binary mesh file");
+	if (header.version != BinaryMeshHeader::CurrentVersion)
+		throw runtime_error("Unsupported binary mesh version " + to_string(header.version));
+	if (header.fileSize != file.size())
+		throw runtime_error("Binary mesh file size does not match its header");
+
+	MeshView mesh;
+	mesh.positions = Section<XMFLOAT3>(file, header.positionsOffset, header.positionCount);
+	mesh.vertexPositions = Section<uint32_t>(file, header.vertexPositionsOffset, header.vertexCount);
+	mesh.normals = Section<XMFLOAT3>(file, header.normalsOffset, header.vertexCount);
+	mesh.faces = Section<Face>(file, header.facesOffset, header.faceCount);
+	mesh.edges = Section<Edge>(file, header.edgesOffset, header.edgeCount);
+	Validate(mesh);
+	return mesh;
+}
+
+MeshData mini::LoadBinaryMesh(const filesystem::path& path)
+{
+	MappedFile file(path);
+	return ViewBinaryMesh(file).ToMeshData();
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "silhouette.h"
+
+//Mesh files: the text formats (mesh1.txt ... mesh6.txt with adjacency, teapot.mesh) and a binary
+//format with the arrays of the first one, laid out so that they can be used straight from a
+//memory-mapped file. Binary files are produced offline with puma_mesh_converter.
+
+namespace mini
+{
+	//Mesh arrays as stored in the files. Vertices are render vertices (position index and normal),
+	//faces index vertices, edges index positions and faces (face1 == UINT_MAX on a boundary).
+	struct MeshData
+	{
+		std::vector<DirectX::XMFLOAT3> positions;
+		std::vector<uint32_t> vertexPositions;
+		std::vector<DirectX::XMFLOAT3> normals;
+		std::vector<Face> faces;
+		std::vector<Edge> edges;
+	};
+
+	//Vertices with texture coordinates and a triangle list (teapot.mesh)
+	struct IndexedMeshData
+	{
+		std::vector<DirectX::XMFLOAT3> positions;
+		std::vector<DirectX::XMFLOAT3> normals;
+		std::vector<DirectX::XMFLOAT2> texCoords;
+		std::vector<uint32_t> indices;
+	};
+
+	template<typename T>
+	struct ArrayView
+	{
+		const T* data = nullptr;
+		size_t size = 0;
+
+		const T* begin() const { return data; }
+		const T* end() const { return data + size; }
+		const T& operator[](size_t i) const { return data[i]; }
+	};
+
+	//Non-owning view of mesh arrays, either in a MeshData or in a mapped binary file
+	struct MeshView
+	{
+		ArrayView<DirectX::XMFLOAT3> positions;
+		ArrayView<uint32_t> vertexPositions;
+		ArrayView<DirectX::XMFLOAT3> normals;
+		ArrayView<Face> faces;
+		ArrayView<Edge> edges;
+
+		MeshView() = default;
+		explicit MeshView(const MeshData& data);
+		MeshData ToMeshData() const;
+	};
+
+	//Read-only mapping of a whole file, unmapped in the destructor
+	class MappedFile
+	{
+	public:
+		//Throws std::runtime_error if the file cannot be opened or mapped
+		explicit MappedFile(const std::filesystem::path& path);
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		const std::byte* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+	private:
+		void close();
+
+		const std::byte* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+
+	//Binary layout: header followed by the arrays in MeshView order, each starting at
+	//a multiple of BinaryMeshAlignment bytes. Little-endian, 32-bit indices.
+	struct BinaryMeshHeader
+	{
+		static constexpr uint32_t Magic = 0x48534d50; // "PMSH"
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint32_t positionCount;
+		uint32_t vertexCount;
+		uint32_t faceCount;
+		uint32_t edgeCount;
+		uint64_t positionsOffset;
+		uint64_t vertexPositionsOffset;
+		uint64_t normalsOffset;
+		uint64_t facesOffset;
+		uint64_t edgesOffset;
+		uint64_t fileSize;
+	};
+	constexpr size_t BinaryMeshAlignment = 16;
+	//Extension of binary mesh files, SMMesh::LoadMesh picks the loader by it
+	constexpr const char* BinaryMeshExtension = ".pmesh";
+
+	//Text loaders parse the whole mapped file in place. Throw std::runtime_error on read errors
+	//and malformed files, TextParseError (with line and column) on malformed tokens.
+	MeshData LoadTextMesh(const std::filesystem::path& path);
+	IndexedMeshData LoadIndexedTextMesh(const std::filesystem::path& path);
+	void SaveTextMesh(const MeshView& mesh, const std::filesystem::path& path);
+	void SaveBinaryMesh(const MeshView& mesh, const std::filesystem::path& path);
+	//Checks the header and every index, the view is valid as long as the file stays mapped.
+	//Throws std::runtime_error if the file is not a valid binary mesh.
+	MeshView ViewBinaryMesh(const MappedFile& file);
+	MeshData LoadBinaryMesh(const std::filesystem::path& path);
+}
@@ -0,0 +1,344 @@
+#include "meshSimplify.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	constexpr uint32_t None = UINT32_MAX;
+
+	//Symmetric 4x4 matrix of the sum of squared distances to planes: xx, xy, xz, xw, yy, yz, yw, zz, zw, ww
+	struct Quadric
+	{
+		double q[10] = {};
+
+		static Quadric Plane(double a, double b, double c, double d)
+		{
+			Quadric r;
+			r.q[0] = a * a; r.q[1] = a * b; r.q[2] = a * c; r.q[3] = a * d;
+			r.q[4] = b * b; r.q[5] = b * c; r.q[6] = b * d;
+			r.q[7] = c * c; r.q[8] = c * d;
+			r.q[9] = d * d;
+			return r;
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			for (int i = 0; i < 10; ++i)
+				q[i] += other.q[i];
+			return *this;
+		}
+
+		double Error(double x, double y, double z) const
+		{
+			double e = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+				+ q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+				+ q[7] * z * z + 2 * q[8] * z + q[9];
+			// bledy zaokraglen moga dac wartosc ujemna
+			return max(e, 0.0);
+		}
+
+		//Point of the smallest error, false if the system is ill-conditioned (flat or straight neighbourhood)
+		bool Minimum(double& x, double& y, double& z) const
+		{
+			const double a00 = q[0], a01 = q[1], a02 = q[2], a11 = q[4], a12 = q[5], a22 = q[7];
+			const double c0 = a11 * a22 - a12 * a12, c1 = a02 * a12 - a01 * a22, c2 = a01 * a12 - a02 * a11;
+			const double det = a00 * c0 + a01 * c1 + a02 * c2;
+			const double scale = a00 + a11 + a22;
+			if (fabs(det) <= 1e-6 * scale * scale * scale)
+				return false;
+			const double b0 = -q[3], b1 = -q[6], b2 = -q[8];
+			x = (c0 * b0 + c1 * b1 + c2 * b2) / det;
+			y = (c1 * b0 + (a00 * a22 - a02 * a02) * b1 + (a02 * a01 - a00 * a12) * b2) / det;
+			z = (c2 * b0 + (a01 * a02 - a00 * a12) * b1 + (a00 * a11 - a01 * a01) * b2) / det;
+			return true;
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		uint32_t from, to;
+		uint32_t fromVersion, toVersion;
+		XMFLOAT3 target;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	class Simplifier
+	{
+	public:
+		Simplifier(const vector<XMFLOAT3>& positions, const vector<Face>& faces)
+			: m_positions(positions), m_faces(faces), m_removed(faces.size(), 0),
+			m_vertexFaces(positions.size()), m_quadrics(positions.size()), m_version(positions.size(), 0),
+			m_alive(positions.size(), 1), m_mark(positions.size(), 0)
+		{
+			for (uint32_t f = 0; f < m_faces.size(); ++f)
+			{
+				XMVECTOR p0 = XMLoadFloat3(&m_positions[m_faces[f].indices[0]]);
+				XMVECTOR p1 = XMLoadFloat3(&m_positions[m_faces[f].indices[1]]);
+				XMVECTOR p2 = XMLoadFloat3(&m_positions[m_faces[f].indices[2]]);
+				XMFLOAT3 n;
+				XMStoreFloat3(&n, XMVector3Normalize(XMVector3Cross(p1 - p0, p2 - p0)));
+				XMFLOAT3 p;
+				XMStoreFloat3(&p, p0);
+				// plaszczyzna z jednostkowa normalna - blad to suma kwadratow odleglosci
+				Quadric plane = Quadric::Plane(n.x, n.y, n.z, -(double(n.x) * p.x + double(n.y) * p.y + double(n.z) * p.z));
+				for (unsigned v : m_faces[f].indices)
+				{
+					m_quadrics[v] += plane;
+					m_vertexFaces[v].push_back(f);
+				}
+			}
+			m_liveFaces = m_faces.size();
+			// kazda krawedz zamknietej siatki wystepuje w dwoch scianach w przeciwnych kierunkach
+			for (const Face& face : m_faces)
+				for (int i = 0; i < 3; ++i)
+				{
+					unsigned a = face.indices[i], b = face.indices[(i + 1) % 3];
+					if (a < b)
+						push(a, b);
+				}
+		}
+
+		float Run(size_t targetFaceCount, float maxError)
+		{
+			const double maxCost = double(maxError) * maxError;
+			double worst = 0.0;
+			while (m_liveFaces > targetFaceCount && !m_queue.empty())
+			{
+				Collapse c = m_queue.top();
+				m_queue.pop();
+				if (!m_alive[c.from] || !m_alive[c.to] || m_version[c.from] != c.fromVersion || m_version[c.to] != c.toVersion)
+					continue;
+				if (c.cost > maxCost)
+					break;
+				if (!canCollapse(c))
+					continue;
+				collapse(c);
+				worst = max(worst, c.cost);
+			}
+			return static_cast<float>(sqrt(worst));
+		}
+
+		SimplifiedMesh Result() const
+		{
+			SimplifiedMesh result;
+			vector<uint32_t> remap(m_positions.size(), None);
+			for (uint32_t f = 0; f < m_faces.size(); ++f)
+			{
+				if (m_removed[f])
+					continue;
+				Face face = m_faces[f];
+				for (unsigned& v : face.indices)
+				{
+					if (remap[v] == None)
+					{
+						remap[v] = static_cast<uint32_t>(result.positions.size());
+						result.positions.push_back(m_positions[v]);
+					}
+					v = remap[v];
+				}
+				result.faces.push_back(face);
+			}
+			return result;
+		}
+
+	private:
+		vector<XMFLOAT3> m_positions;
+		vector<Face> m_faces;
+		vector<uint8_t> m_removed;
+		vector<vector<uint32_t>> m_vertexFaces;
+		vector<Quadric> m_quadrics;
+		vector<uint32_t> m_version;
+		vector<uint8_t> m_alive;
+		//Scratch marks of neighbours of the collapsed edge, compared with stamps (never overflow)
+		vector<uint64_t> m_mark;
+		uint64_t m_stamp = 0;
+		vector<uint32_t> m_neighbours;
+		size_t m_liveFaces = 0;
+		priority_queue<Collapse, vector<Collapse>, greater<Collapse>> m_queue;
+
+		void push(uint32_t a, uint32_t b)
+		{
+			Quadric q = m_quadrics[a];
+			q += m_quadrics[b];
+			const XMFLOAT3& pa = m_positions[a];
+			const XMFLOAT3& pb = m_positions[b];
+			// optimum kwadryki, a gdy uklad jest osobliwy (plaszczyzna, krawedz ostra) lub optimum
+			// lezy daleko od krawedzi - najlepszy z koncow i srodka krawedzi
+			double x, y, z;
+			Collapse c = { 0.0, a, b, m_version[a], m_version[b], {} };
+			const double mx = (pa.x + pb.x) / 2.0, my = (pa.y + pb.y) / 2.0, mz = (pa.z + pb.z) / 2.0;
+			const double dx = pb.x - pa.x, dy = pb.y - pa.y, dz = pb.z - pa.z;
+			if (q.Minimum(x, y, z) &&
+				(x - mx) * (x - mx) + (y - my) * (y - my) + (z - mz) * (z - mz) <= dx * dx + dy * dy + dz * dz)
+			{
+				c.cost = q.Error(x, y, z);
+				c.target = { float(x), float(y), float(z) };
+			}
+			else
+			{
+				const XMFLOAT3 candidates[] = { pa, pb, { (pa.x + pb.x) / 2, (pa.y + pb.y) / 2, (pa.z + pb.z) / 2 } };
+				c.cost = numeric_limits<double>::infinity();
+				for (const XMFLOAT3& p : candidates)
+				{
+					double e = q.Error(p.x, p.y, p.z);
+					if (e < c.cost)
+					{
+						c.cost = e;
+						c.target = p;
+					}
+				}
+			}
+			m_queue.push(c);
+		}
+
+		template<typename F>
+		void forEachFace(uint32_t v, F&& f) const
+		{
+			for (uint32_t face : m_vertexFaces[v])
+				if (!m_removed[face])
+					f(face);
+		}
+
+		bool hasVertex(uint32_t face, uint32_t v) const
+		{
+			const unsigned* idx = m_faces[face].indices;
+			return idx[0] == v || idx[1] == v || idx[2] == v;
+		}
+
+		size_t valence(uint32_t v) const
+		{
+			size_t count = 0;
+			forEachFace(v, [&](uint32_t) { ++count; });
+			// w zamknietej rozmaitosci tyle samo sasiadow co scian
+			return count;
+		}
+
+		bool canCollapse(const Collapse& c)
+		{
+			const uint32_t a = c.from, b = c.to;
+			// warunek lacza: wspolni sasiedzi a i b to tylko wierzcholki dwoch scian krawedzi
+			const uint64_t ofA = ++m_stamp, seen = ++m_stamp;
+			size_t shared = 0, neighbours = 0;
+			forEachFace(a, [&](uint32_t f)
+			{
+				for (unsigned v : m_faces[f].indices)
+					if (v != a && v != b && m_mark[v] != ofA)
+					{
+						m_mark[v] = ofA;
+						++neighbours;
+					}
+			});
+			m_neighbours.clear();
+			forEachFace(b, [&](uint32_t f)
+			{
+				for (unsigned v : m_faces[f].indices)
+				{
+					if (v == b || v == a || m_mark[v] == seen)
+						continue;
+					if (m_mark[v] == ofA)
+					{
+						m_neighbours.push_back(v);
+						++shared;
+					}
+					else
+						++neighbours;
+					m_mark[v] = seen;
+				}
+			});
+			size_t edgeFaces = 0;
+			forEachFace(a, [&](uint32_t f) { edgeFaces += hasVertex(f, b); });
+			if (shared != 2 || edgeFaces != 2)
+				return false;
+			// po sklejeniu kazdy wierzcholek musi miec co najmniej trzech sasiadow (bez zapadania czworoscianow)
+			if (neighbours < 3)
+				return false;
+			for (uint32_t v : m_neighbours)
+				if (valence(v) <= 3)
+					return false;
+
+			// sciany nie moga sie odwrocic ani zdegenerowac
+			const XMVECTOR target = XMLoadFloat3(&c.target);
+			bool valid = true;
+			auto check = [&](uint32_t moved)
+			{
+				forEachFace(moved, [&](uint32_t f)
+				{
+					if (!valid || (hasVertex(f, a) && hasVertex(f, b)))
+						return;
+					const unsigned* idx = m_faces[f].indices;
+					XMVECTOR p[3], q[3];
+					for (int i = 0; i < 3; ++i)
+					{
+						p[i] = XMLoadFloat3(&m_positions[idx[i]]);
+						q[i] = idx[i] == moved ? target : p[i];
+					}
+					XMVECTOR before = XMVector3Cross(p[1] - p[0], p[2] - p[0]);
+					XMVECTOR after = XMVector3Cross(q[1] - q[0], q[2] - q[0]);
+					if (!(XMVectorGetX(XMVector3Dot(before, after)) > 0.f))
+						valid = false;
+				});
+			};
+			check(a);
+			check(b);
+			return valid;
+		}
+
+		void collapse(const Collapse& c)
+		{
+			const uint32_t a = c.from, b = c.to;
+			vector<uint32_t> faces;
+			forEachFace(a, [&](uint32_t f)
+			{
+				if (hasVertex(f, b))
+				{
+					m_removed[f] = 1;
+					--m_liveFaces;
+				}
+				else
+					faces.push_back(f);
+			});
+			forEachFace(b, [&](uint32_t f)
+			{
+				for (unsigned& v : m_faces[f].indices)
+					if (v == b)
+						v = a;
+				faces.push_back(f);
+			});
+			m_vertexFaces[a].swap(faces);
+			m_vertexFaces[b] = {};
+			m_alive[b] = 0;
+			m_positions[a] = c.target;
+			m_quadrics[a] += m_quadrics[b];
+			++m_version[a];
+
+			// nowe koszty krawedzi wychodzacych z a
+			const uint64_t stamp = ++m_stamp;
+			m_mark[a] = stamp;
+			forEachFace(a, [&](uint32_t f)
+			{
+				for (unsigned v : m_faces[f].indices)
+					if (m_mark[v] != stamp)
+					{
+						m_mark[v] = stamp;
+						push(a, v);
+					}
+			});
+		}
+	};
+}
+
+SimplifiedMesh mini::SimplifyMesh(const vector<XMFLOAT3>& positions, const vector<Face>& faces, size_t targetFaceCount, float maxError)
+{
+	Simplifier simplifier(positions, faces);
+	float error = simplifier.Run(targetFaceCount, maxError);
+	SimplifiedMesh result = simplifier.Result();
+	result.error = error;
+	return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <DirectXMath.h>
+#include <limits>
+#include <vector>
+#include "silhouette.h"
+
+//Edge collapse simplification of closed triangle meshes with quadric error metrics
+//(Garland, Heckbert), for lower detail shadow casters.
+
+namespace mini
+{
+	struct SimplifiedMesh
+	{
+		std::vector<DirectX::XMFLOAT3> positions;
+		//Index positions
+		std::vector<Face> faces;
+		//Upper bound of the distance of every vertex from the planes of the original faces
+		//merged into it (square root of the largest quadric error of a collapse)
+		float error = 0.f;
+	};
+
+	//Collapses edges in order of quadric error until at most targetFaceCount faces remain
+	//or the next collapse would exceed maxError. Faces index positions. Collapses that would
+	//make the surface non-manifold, flip a face or shrink a part below a tetrahedron are skipped,
+	//so a closed manifold mesh stays closed and manifold.
+	SimplifiedMesh SimplifyMesh(const std::vector<DirectX::XMFLOAT3>& positions, const std::vector<Face>& faces,
+		size_t targetFaceCount, float maxError = std::numeric_limits<float>::infinity());
+}
@@ -0,0 +1,225 @@
+#include "meshlets.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	constexpr uint32_t None = UINT32_MAX;
+	//Cosine of the largest angle between the normal of an added face and the cone axis;
+	//a meshlet ends early when no neighbouring face is closer
+	constexpr float MinAxisCos = 0.5f;
+
+	void SetBounds(Meshlet& meshlet, const vector<XMFLOAT3>& vertices, const vector<Face>& faces, const vector<XMFLOAT3>& normals)
+	{
+		XMVECTOR minP = XMVectorReplicate(FLT_MAX), maxP = XMVectorReplicate(-FLT_MAX), axis = XMVectorZero();
+		const uint32_t last = meshlet.firstFace + meshlet.faceCount;
+		for (uint32_t f = meshlet.firstFace; f < last; ++f)
+		{
+			for (unsigned v : faces[f].indices)
+			{
+				minP = XMVectorMin(minP, XMLoadFloat3(&vertices[v]));
+				maxP = XMVectorMax(maxP, XMLoadFloat3(&vertices[v]));
+			}
+			axis += XMLoadFloat3(&normals[f]);
+		}
+		XMVECTOR center = (minP + maxP) * 0.5f;
+		float radiusSq = 0.f, minCos = 1.f;
+		axis = XMVector3Normalize(axis);
+		for (uint32_t f = meshlet.firstFace; f < last; ++f)
+		{
+			for (unsigned v : faces[f].indices)
+				radiusSq = max(radiusSq, XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&vertices[v]) - center)));
+			// zdegenerowana sciana (zerowa normalna) daje 0 - stozek nigdy nie rozstrzyga
+			minCos = min(minCos, XMVectorGetX(XMVector3Dot(XMLoadFloat3(&normals[f]), axis)));
+		}
+		XMStoreFloat3(&meshlet.center, center);
+		meshlet.radius = sqrtf(radiusSq);
+		XMStoreFloat3(&meshlet.coneAxis, axis);
+		meshlet.coneCutoff = minCos > 0.f ? sqrtf(max(0.f, 1.f - minCos * minCos)) : numeric_limits<float>::infinity();
+	}
+}
+
+MeshletSide mini::ClassifyMeshlet(const Meshlet& meshlet, XMFLOAT3 point)
+{
+	if (meshlet.coneCutoff == numeric_limits<float>::infinity())
+		return MeshletSide::Mixed;
+	// kierunki z punktu do kuli odchylone od kierunku do srodka najwyzej o asin(r / D);
+	// cos(kat do osi) > sin(polowa kata stozka) + r / D wystarcza, by wszystkie sciany lezaly po jednej stronie
+	XMVECTOR toCenter = XMLoadFloat3(&meshlet.center) - XMLoadFloat3(&point);
+	float distance = XMVectorGetX(XMVector3Length(toCenter));
+	float dot = XMVectorGetX(XMVector3Dot(toCenter, XMLoadFloat3(&meshlet.coneAxis)));
+	float limit = meshlet.coneCutoff * distance + meshlet.radius;
+	if (dot > limit)
+		return MeshletSide::Back;
+	if (-dot > limit)
+		return MeshletSide::Front;
+	return MeshletSide::Mixed;
+}
+
+vector<Meshlet> mini::BuildMeshlets(const vector<XMFLOAT3>& vertices, vector<Face>& faces, vector<Edge>& edges, unsigned maxFaces)
+{
+	const size_t faceCount = faces.size();
+	vector<XMFLOAT3> normals(faceCount);
+	for (size_t f = 0; f < faceCount; ++f)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&vertices[faces[f].indices[0]]);
+		XMVECTOR p1 = XMLoadFloat3(&vertices[faces[f].indices[1]]);
+		XMVECTOR p2 = XMLoadFloat3(&vertices[faces[f].indices[2]]);
+		XMStoreFloat3(&normals[f], XMVector3Normalize(XMVector3Cross(p1 - p0, p2 - p0)));
+	}
+	FaceEdges faceEdges;
+	faceEdges.Build(edges, faceCount);
+
+	// rozrost od pierwszej wolnej sciany przez krawedzie, najpierw sciany najblizsze osi stozka
+	vector<uint32_t> meshletOf(faceCount, None), queued(faceCount, None), order, members, frontier;
+	order.reserve(faceCount);
+	vector<Meshlet> meshlets;
+	for (uint32_t seed = 0; seed < faceCount; ++seed)
+	{
+		if (meshletOf[seed] != None)
+			continue;
+		const auto id = static_cast<uint32_t>(meshlets.size());
+		members.clear();
+		frontier.clear();
+		XMVECTOR axisSum = XMVectorZero();
+		auto add = [&](uint32_t f)
+		{
+			meshletOf[f] = id;
+			members.push_back(f);
+			axisSum += XMLoadFloat3(&normals[f]);
+			for (uint32_t i = faceEdges.start[f]; i < faceEdges.start[f + 1]; ++i)
+			{
+				const Edge& e = edges[faceEdges.edges[i]];
+				uint32_t g = e.face0 == f ? e.face1 : e.face0;
+				if (g != UINT_MAX && meshletOf[g] == None && queued[g] != id)
+				{
+					queued[g] = id;
+					frontier.push_back(g);
+				}
+			}
+		};
+		add(seed);
+		while (members.size() < maxFaces && !frontier.empty())
+		{
+			XMVECTOR axis = XMVector3Normalize(axisSum);
+			size_t best = 0;
+			float bestCos = -FLT_MAX;
+			for (size_t i = 0; i < frontier.size(); ++i)
+			{
+				float c = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&normals[frontier[i]]), axis));
+				if (c > bestCos)
+				{
+					bestCos = c;
+					best = i;
+				}
+			}
+			if (bestCos < MinAxisCos)
+				break;
+			uint32_t f = frontier[best];
+			frontier[best] = frontier.back();
+			frontier.pop_back();
+			add(f);
+		}
+		// wzgledna kolejnosc scian zachowana (kolejnosc dla pamieci podrecznej wierzcholkow)
+		sort(members.begin(), members.end());
+		Meshlet meshlet = {};
+		meshlet.firstFace = static_cast<uint32_t>(order.size());
+		meshlet.faceCount = static_cast<uint32_t>(members.size());
+		order.insert(order.end(), members.begin(), members.end());
+		meshlets.push_back(meshlet);
+	}
+
+	vector<uint32_t> newFace(faceCount);
+	vector<Face> reordered(faceCount);
+	vector<XMFLOAT3> reorderedNormals(faceCount);
+	for (uint32_t i = 0; i < faceCount; ++i)
+	{
+		newFace[order[i]] = i;
+		reordered[i] = faces[order[i]];
+		reorderedNormals[i] = normals[order[i]];
+	}
+	faces.swap(reordered);
+	for (Meshlet& meshlet : meshlets)
+		SetBounds(meshlet, vertices, faces, reorderedNormals);
+
+	// krawedzie wewnatrz meshletow pogrupowane (sortowanie przez zliczanie), krawedzie miedzy meshletami na koncu
+	const size_t border = meshlets.size();
+	auto group = [&](const Edge& e)
+	{
+		uint32_t m0 = meshletOf[e.face0];
+		uint32_t m1 = e.face1 == UINT_MAX ? m0 : meshletOf[e.face1];
+		return m0 == m1 ? m0 : border;
+	};
+	vector<uint32_t> offsets(border + 2, 0);
+	for (const Edge& e : edges)
+		++offsets[group(e) + 1];
+	for (size_t g = 0; g <= border; ++g)
+		offsets[g + 1] += offsets[g];
+	for (size_t m = 0; m < border; ++m)
+	{
+		meshlets[m].firstEdge = offsets[m];
+		meshlets[m].edgeCount = offsets[m + 1] - offsets[m];
+	}
+	vector<Edge> grouped(edges.size());
+	for (const Edge& e : edges)
+	{
+		Edge& g = grouped[offsets[group(e)]++];
+		g = e;
+		g.face0 = newFace[e.face0];
+		if (e.face1 != UINT_MAX)
+			g.face1 = newFace[e.face1];
+	}
+	edges.swap(grouped);
+	return meshlets;
+}
+
+size_t mini::GatherMeshletSilhouette(const vector<Meshlet>& meshlets, const FacePlanes& planes, const EdgeFaces& edges,
+	XMFLOAT3 lightPos, bool flip, FaceBitset& facing, vector<uint32_t>& silhouette, SimdLevel level)
+{
+	facing.reset(planes.count);
+	silhouette.clear();
+	size_t skipped = 0;
+	for (const Meshlet& meshlet : meshlets)
+	{
+		MeshletSide side = ClassifyMeshlet(meshlet, lightPos);
+		if (side == MeshletSide::Mixed)
+		{
+			// krawedzie wewnatrz meshletu zaleza tylko od jego scian
+			ClassifyFaces(planes, lightPos, flip, meshlet.firstFace, meshlet.faceCount, facing, level);
+			GatherSilhouetteEdges(edges, facing, meshlet.firstEdge, meshlet.edgeCount, silhouette, level);
+			continue;
+		}
+		// odbicie zamienia strony
+		if ((side == MeshletSide::Back) != flip)
+			facing.set(meshlet.firstFace, meshlet.faceCount);
+		++skipped;
+	}
+	size_t border = MeshletBorderEdges(meshlets);
+	GatherSilhouetteEdges(edges, facing, border, edges.count - border, silhouette, level);
+	return skipped;
+}
+
+size_t mini::VisibleMeshletFaces(const vector<Meshlet>& meshlets, XMFLOAT3 eye, vector<FaceRange>& ranges)
+{
+	ranges.clear();
+	size_t culled = 0;
+	for (const Meshlet& meshlet : meshlets)
+	{
+		if (ClassifyMeshlet(meshlet, eye) == MeshletSide::Back)
+		{
+			++culled;
+			continue;
+		}
+		if (!ranges.empty() && ranges.back().first + ranges.back().count == meshlet.firstFace)
+			ranges.back().count += meshlet.faceCount;
+		else
+			ranges.push_back({ meshlet.firstFace, meshlet.faceCount });
+	}
+	return culled;
+}
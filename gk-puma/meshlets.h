@@ -0,0 +1,73 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "silhouette.h"
+
+//Clusters of neighbouring faces with similar normals. A bounding sphere and a cone of normals
+//per cluster tell when all of its faces are turned toward or away from a point, so silhouette
+//extraction and drawing can skip whole clusters instead of testing faces one by one.
+
+namespace mini
+{
+	//Default size of meshlets built by BuildMeshlets
+	constexpr unsigned MeshletMaxFaces = 64;
+
+	//Faces firstFace .. firstFace + faceCount - 1 and edges firstEdge .. firstEdge + edgeCount - 1
+	//(edges between two faces of the meshlet) of a mesh ordered by BuildMeshlets.
+	//All faces lie in the sphere; the angle between a face normal and coneAxis is at most
+	//the cone half-angle, coneCutoff is its sine (infinity if the cone is not narrower than a hemisphere).
+	struct Meshlet
+	{
+		DirectX::XMFLOAT3 center;
+		float radius;
+		DirectX::XMFLOAT3 coneAxis;
+		float coneCutoff;
+		uint32_t firstFace, faceCount;
+		uint32_t firstEdge, edgeCount;
+	};
+
+	//Side of the faces of a meshlet seen from a point
+	enum class MeshletSide
+	{
+		//Some faces may be turned toward the point and some away
+		Mixed,
+		//All faces turned toward the point
+		Front,
+		//All faces turned away from the point
+		Back
+	};
+
+	//Conservative: Front or Back only if it holds for every face of the meshlet
+	MeshletSide ClassifyMeshlet(const Meshlet& meshlet, DirectX::XMFLOAT3 point);
+
+	//Partitions faces into meshlets of at most maxFaces faces, grown greedily over edges from
+	//the first unassigned face, preferring faces with normals close to the meshlet's cone axis.
+	//Faces are reordered so that every meshlet is a contiguous range (keeping their relative order,
+	//and so most of the vertex cache order), edges are reordered by meshlet, edges between
+	//meshlets go last; face indices of edges are updated. Faces index vertices.
+	std::vector<Meshlet> BuildMeshlets(const std::vector<DirectX::XMFLOAT3>& vertices,
+		std::vector<Face>& faces, std::vector<Edge>& edges, unsigned maxFaces = MeshletMaxFaces);
+
+	//First edge between two different meshlets (edges.size() if there are none)
+	inline size_t MeshletBorderEdges(const std::vector<Meshlet>& meshlets)
+	{
+		return meshlets.empty() ? 0 : meshlets.back().firstEdge + meshlets.back().edgeCount;
+	}
+
+	//Same results as ClassifyFaces + GatherSilhouetteEdges, for planes and edges of a mesh ordered
+	//by BuildMeshlets. Faces of meshlets entirely in front of or behind the light are not tested
+	//and edges inside them are skipped. Returns the number of skipped meshlets.
+	size_t GatherMeshletSilhouette(const std::vector<Meshlet>& meshlets, const FacePlanes& planes,
+		const EdgeFaces& edges, DirectX::XMFLOAT3 lightPos, bool flip, FaceBitset& facing,
+		std::vector<uint32_t>& silhouette, SimdLevel level = DetectSimdLevel());
+
+	struct FaceRange
+	{
+		uint32_t first, count;
+	};
+
+	//Faces of meshlets not entirely turned away from eye (back-face culling of whole meshlets),
+	//consecutive meshlets merged into one range. Returns the number of culled meshlets.
+	size_t VisibleMeshletFaces(const std::vector<Meshlet>& meshlets, DirectX::XMFLOAT3 eye, std::vector<FaceRange>& ranges);
+}
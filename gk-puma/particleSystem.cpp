@@ -1,23 +1,13 @@
 #include "particleSystem.h"
 
+#include <algorithm>
 #include <iterator>
 
-#include "dxDevice.h"
-#include "exceptions.h"
-
 using namespace mini;
 using namespace gk2;
 using namespace DirectX;
 using namespace std;
 
-const D3D11_INPUT_ELEMENT_DESC ParticleVertex::Layout[4] =
-{
-	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "POSITION",1, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "TEXCOORD", 0, DXGI_FORMAT_R32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "TEXCOORD", 1, DXGI_FORMAT_R32_FLOAT, 0, 28, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-};
-
 const float ParticleSystem::TIME_TO_LIVE = 1.0f;
 const float ParticleSystem::EMISSION_RATE = 200.0f;
 const float ParticleSystem::MAX_ANGLE = XM_PIDIV2 / 9.0f;
@@ -26,11 +16,11 @@ const float ParticleSystem::MAX_VELOCITY = 2.33f;
 const float ParticleSystem::PARTICLE_SIZE = 0.08f;
 const int ParticleSystem::MAX_PARTICLES = 5000;
 
-ParticleSystem::ParticleSystem(DirectX::XMFLOAT3 emmiterPosition)
-	: m_emitterPos(emmiterPosition), m_particlesToCreate(0.0f), m_random(random_device{}())
+ParticleSystem::ParticleSystem(DirectX::XMFLOAT3 emmiterPosition, unsigned int seed)
+	: m_emitterPos(emmiterPosition), m_particlesToCreate(0.0f), m_random(seed)
 { }
 
-vector<ParticleVertex> ParticleSystem::Update(float dt, DirectX::XMFLOAT4 cameraPosition)
+void ParticleSystem::Update(float dt)
 {
 	size_t removeCount = 0;
 	for (auto& p : m_particles)
@@ -49,14 +39,14 @@ vector<ParticleVertex> ParticleSystem::Update(float dt, DirectX::XMFLOAT4 camera
 		if (m_particles.size() < MAX_PARTICLES)
 			m_particles.push_back(RandomParticle());
 	}
-	return GetParticleVerts(cameraPosition);
 }
 
 XMFLOAT3 ParticleSystem::RandomVelocity()
 {
-	static uniform_real_distribution angleDist{ -XM_PIDIV4, XM_PIDIV4 };
-	static uniform_real_distribution magnitudeDist{ 0.f, tan(MAX_ANGLE) };
-	static uniform_real_distribution velDist{ MIN_VELOCITY, MAX_VELOCITY };
+	// rozklady bez stanu statycznego - caly stan symulacji jest w m_random
+	uniform_real_distribution angleDist{ -XM_PIDIV4, XM_PIDIV4 };
+	uniform_real_distribution magnitudeDist{ 0.f, tan(MAX_ANGLE) };
+	uniform_real_distribution velDist{ MIN_VELOCITY, MAX_VELOCITY };
 	float angle = angleDist(m_random);
 	float magnitude = magnitudeDist(m_random);
 	XMFLOAT3 v{ cos(-angle)*magnitude, 0.0f, sin(-angle)*magnitude };
@@ -92,13 +82,19 @@ void ParticleSystem::UpdateParticle(Particle& p, float dt)
 	p.Vertex.Pos.z += p.Velocities.Velocity.z * dt;
 }
 
-vector<ParticleVertex> ParticleSystem::GetParticleVerts(DirectX::XMFLOAT4 cameraPosition)
+vector<ParticleVertex> ParticleSystem::GetParticleVerts(DirectX::XMFLOAT4 cameraPosition, float alpha) const
 {
 	vector<ParticleVertex> vertices;
 	// TODO : 1.29 Copy particles' vertex data to a vector and sort them
 
-	std::transform(m_particles.begin(), m_particles.end(), std::back_inserter(vertices), [](const auto& particle) {
-		return particle.Vertex;
+	// polozenie miedzy dwiema ostatnimi aktualizacjami, smuga przesunieta razem z czastka
+	std::transform(m_particles.begin(), m_particles.end(), std::back_inserter(vertices), [alpha](const auto& particle) {
+		ParticleVertex v = particle.Vertex;
+		XMVECTOR pos = XMLoadFloat3(&v.Pos), prev = XMLoadFloat3(&v.PrevPos);
+		XMVECTOR shift = (1.0f - alpha) * (pos - prev);
+		XMStoreFloat3(&v.Pos, pos - shift);
+		XMStoreFloat3(&v.PrevPos, prev - shift);
+		return v;
 		});
 
 	std::sort(vertices.begin(), vertices.end(), [&](const auto& v1, const auto& v2) {
@@ -2,7 +2,6 @@
 #include <DirectXMath.h>
 #include <vector>
 #include <random>
-#include <d3d11.h>
 
 namespace mini
 {
@@ -14,7 +13,7 @@ namespace mini
 			DirectX::XMFLOAT3 PrevPos;
 			float Age;
 			float Size;
-			static const D3D11_INPUT_ELEMENT_DESC Layout[4];
+			//Input layout is ParticleVertexLayout in vertexTypes.h, the simulation does not depend on Direct3D
 
 			ParticleVertex() : Pos(0.0f, 0.0f, 0.0f), PrevPos(0.0f, 0.0f, 0.0f), Age(0.0f), Size(0.0f) { }
 		};
@@ -39,13 +38,17 @@ namespace mini
 
 			ParticleSystem(ParticleSystem&& other) = default;
 
-			ParticleSystem(DirectX::XMFLOAT3 emmiterPosition);
+			//The same seed and the same sequence of updates give bit-identical particles
+			explicit ParticleSystem(DirectX::XMFLOAT3 emmiterPosition, unsigned int seed = 0);
 
 			ParticleSystem& operator=(ParticleSystem&& other) = default;
 
-			std::vector<ParticleVertex> Update(float dt, DirectX::XMFLOAT4 cameraPosition);
+			void Update(float dt);
 			void SetEmitterPosition(DirectX::XMFLOAT3 position) { m_emitterPos = position; }
 			size_t particlesCount() const { return m_particles.size(); }
+			const std::vector<Particle>& particles() const { return m_particles; }
+			//Vertices sorted back to front, alpha in [0, 1] places them between the last two updates
+			std::vector<ParticleVertex> GetParticleVerts(DirectX::XMFLOAT4 cameraPosition, float alpha = 1.0f) const;
 			static const int MAX_PARTICLES;		//maximal number of particles in the system
 
 		private:
@@ -57,17 +60,17 @@ namespace mini
 			static const float MAX_VELOCITY;	//maximal value of particle's velocity
 			static const float PARTICLE_SIZE;	//initial size of a particle
 
-			DirectX::XMFLOAT3 m_emitterPos;
-			float m_particlesToCreate;
+			DirectX::XMFLOAT3 m_emitterPos = { 0.0f, 0.0f, 0.0f };
+			float m_particlesToCreate = 0.0f;
 
 			std::vector<Particle> m_particles;
 
-			std::default_random_engine m_random;
+			//Engine of the same sequence on every platform (default_random_engine is implementation defined)
+			std::mt19937 m_random;
 
 			DirectX::XMFLOAT3 RandomVelocity();
 			Particle RandomParticle();
 			static void UpdateParticle(Particle& p, float dt);
-			std::vector<ParticleVertex> GetParticleVerts(DirectX::XMFLOAT4 cameraPosition);
 		};
 	}
 }
\ No newline at end of file
@@ -14,6 +14,8 @@ cbuffer cbProj : register(b2) //Vertex Shader constant buffer slot 2
 	matrix projMatrix;
 };
 
+#include "vertexDecode.hlsli"
+
 struct VSInput
 {
 	float3 pos : POSITION;
@@ -31,10 +33,10 @@ struct PSInput
 PSInput main(VSInput i)
 {
 	PSInput o;
-	o.worldPos = mul(worldMatrix, float4(i.pos, 1.0f)).xyz;
+	o.worldPos = mul(worldMatrix, float4(DecodePosition(i.pos), 1.0f)).xyz;
 	o.pos = mul(viewMatrix, float4(o.worldPos, 1.0f));
 	o.pos = mul(projMatrix, o.pos);
-	o.norm = mul(worldMatrix, float4(i.norm, 0.0f)).xyz;
+	o.norm = mul(worldMatrix, float4(DecodeNormal(i.norm), 0.0f)).xyz;
 	o.norm = normalize(o.norm);
 	float3 camPos = mul(invViewMatrix, float4(0.0f, 0.0f, 0.0f, 1.0f)).xyz;
 	o.viewVec = camPos - o.worldPos;
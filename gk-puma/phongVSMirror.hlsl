@@ -14,6 +14,8 @@ cbuffer cbProj : register(b2) //Vertex Shader constant buffer slot 2
 	matrix projMatrix;
 };
 
+#include "vertexDecode.hlsli"
+
 cbuffer mirrorBuf : register(b3) //Vertex Shader constant buffer slot 3
 {
     float4 mirrorPoint;
@@ -38,14 +40,14 @@ struct PSInput
 PSInput main(VSInput i)
 {
 	PSInput o;
-	o.worldPos = mul(worldMatrix, float4(i.pos, 1.0f)).xyz;
+	o.worldPos = mul(worldMatrix, float4(DecodePosition(i.pos), 1.0f)).xyz;
 
     float3 mirrorToPoint = o.worldPos - mirrorPoint.xyz;
     o.clipDist = dot(mirrorToPoint, mirrorNormal.xyz);
 	
 	o.pos = mul(viewMatrix, float4(o.worldPos, 1.0f));
 	o.pos = mul(projMatrix, o.pos);
-	o.norm = mul(worldMatrix, float4(i.norm, 0.0f)).xyz;
+	o.norm = mul(worldMatrix, float4(DecodeNormal(i.norm), 0.0f)).xyz;
 	o.norm = normalize(o.norm);
 	float3 camPos = mul(invViewMatrix, float4(0.0f, 0.0f, 0.0f, 1.0f)).xyz;
 	o.viewVec = camPos - o.worldPos;
@@ -0,0 +1,492 @@
+#include "pumaKinematics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "blockRange.h"
+#include "vectorMath.h"
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	//Tolerance of the elbow cosine outside [-1, 1], so that fully stretched poses from forward kinematics stay reachable
+	constexpr float ReachTolerance = 1e-5f;
+
+	XMVECTOR LoadBlock(const vector<float>& v, size_t i)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&v[i]));
+	}
+
+	void StoreBlock(vector<float>& v, size_t i, FXMVECTOR value)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&v[i]), value);
+	}
+
+	float Splat(float v, float) { return v; }
+	XMVECTOR Splat(float v, FXMVECTOR) { return XMVectorReplicate(v); }
+
+	//Rotation of (x, y, z) as by XMMatrixRotationX/Y/Z: u' = u c - w s, w' = u s + w c
+	//for the pairs (y, z), (z, x) and (x, y). T is float or XMVECTOR (KinematicsBlock lanes).
+	template<typename T>
+	void Rotate(JointAxis axis, T c, T s, T& x, T& y, T& z)
+	{
+		T& u = axis == JointAxis::X ? y : axis == JointAxis::Y ? z : x;
+		T& w = axis == JointAxis::X ? z : axis == JointAxis::Y ? x : y;
+		T u1 = u * c - w * s;
+		w = u * s + w * c;
+		u = u1;
+	}
+
+	//Moves the tool from the rest pose, joints from the wrist down to the base
+	template<typename T>
+	void MoveTool(const PumaJoint* joints, const T* c, const T* s, T* position, T* normal)
+	{
+		for (size_t j = PumaJointCount; j-- > 0;)
+		{
+			const PumaJoint& joint = joints[j];
+			T px = position[0] - Splat(joint.pivot.x, c[j]);
+			T py = position[1] - Splat(joint.pivot.y, c[j]);
+			T pz = position[2] - Splat(joint.pivot.z, c[j]);
+			Rotate(joint.axis, c[j], s[j], px, py, pz);
+			position[0] = px + Splat(joint.pivot.x, c[j]);
+			position[1] = py + Splat(joint.pivot.y, c[j]);
+			position[2] = pz + Splat(joint.pivot.z, c[j]);
+			Rotate(joint.axis, c[j], s[j], normal[0], normal[1], normal[2]);
+		}
+	}
+
+	XMMATRIX Rotation(JointAxis axis, float angle)
+	{
+		switch (axis)
+		{
+		case JointAxis::X:
+			return XMMatrixRotationX(angle);
+		case JointAxis::Y:
+			return XMMatrixRotationY(angle);
+		default:
+			return XMMatrixRotationZ(angle);
+		}
+	}
+
+	XMVECTOR AxisVector(JointAxis axis)
+	{
+		switch (axis)
+		{
+		case JointAxis::X:
+			return XMVectorSet(1.f, 0.f, 0.f, 0.f);
+		case JointAxis::Y:
+			return XMVectorSet(0.f, 1.f, 0.f, 0.f);
+		default:
+			return XMVectorSet(0.f, 0.f, 1.f, 0.f);
+		}
+	}
+
+	//Solves a x = b for a symmetric positive definite a (Cholesky decomposition in place), x replaces b
+	template<size_t N>
+	void SolvePositiveDefinite(float a[N][N], float b[N])
+	{
+		for (size_t j = 0; j < N; ++j)
+		{
+			for (size_t k = 0; k < j; ++k)
+				a[j][j] -= a[j][k] * a[j][k];
+			a[j][j] = sqrtf(a[j][j]);
+			for (size_t i = j + 1; i < N; ++i)
+			{
+				for (size_t k = 0; k < j; ++k)
+					a[i][j] -= a[i][k] * a[j][k];
+				a[i][j] /= a[j][j];
+			}
+		}
+		// L y = b, potem L^T x = y
+		for (size_t i = 0; i < N; ++i)
+		{
+			for (size_t k = 0; k < i; ++k)
+				b[i] -= a[i][k] * b[k];
+			b[i] /= a[i][i];
+		}
+		for (size_t i = N; i-- > 0;)
+		{
+			for (size_t k = i + 1; k < N; ++k)
+				b[i] -= a[k][i] * b[k];
+			b[i] /= a[i][i];
+		}
+	}
+
+	//Closed form inverse kinematics of KinematicsBlock lanes: wrist centers p, unit tool normals n (rotated
+	//in place). Per lane branch signs: reachSign -1 turns the base to reach backwards, elbowSign +1 bends
+	//the elbow up (the application uses -1), wristSign -1 flips the wrist.
+	void SolveBlock(const PumaLinks& links, const XMVECTOR p[3], XMVECTOR n[3], FXMVECTOR reachSign, FXMVECTOR elbowSign,
+		FXMVECTOR wristSign, XMVECTOR angles[PumaJointCount], XMVECTOR& reach, XMVECTOR& conditioning)
+	{
+		const float l1 = links.upperArm, l2 = links.forearm;
+		const XMVECTOR zero = XMVectorZero(), one = XMVectorSplatOne();
+		const XMVECTOR dz = XMVectorReplicate(links.wristOffset);
+
+		XMVECTOR e2 = p[0] * p[0] + p[2] * p[2] - dz * dz;
+		reach = XMVectorGreaterOrEqual(e2, zero);
+		e2 = XMVectorMax(e2, zero);
+		XMVECTOR e = XMVectorSqrt(e2);
+		XMVECTOR reachE = e * reachSign;
+		angles[0] = VectorATan2(p[2], -p[0]) + VectorATan2(dz, reachE);
+
+		XMVECTOR y = p[1] - XMVectorReplicate(links.shoulderHeight);
+		XMVECTOR cos2 = (e2 + y * y - XMVectorReplicate(l1 * l1 + l2 * l2)) * XMVectorReplicate(0.5f / (l1 * l2));
+		reach = XMVectorAndInt(reach, XMVectorLessOrEqual(XMVectorAbs(cos2), XMVectorReplicate(1.f + ReachTolerance)));
+		cos2 = XMVectorClamp(cos2, -one, one);
+		angles[2] = elbowSign * VectorACos(cos2);
+		XMVECTOR sin2 = elbowSign * XMVectorSqrt((one - cos2) * (one + cos2));
+		const XMVECTOR vl1 = XMVectorReplicate(l1), vl2 = XMVectorReplicate(l2);
+		angles[1] = -VectorATan2(y, reachE) - VectorATan2(vl2 * sin2, XMVectorMultiplyAdd(vl2, cos2, vl1));
+
+		XMVECTOR c, s;
+		XMVectorSinCos(&s, &c, angles[0]);
+		Rotate(JointAxis::Y, c, -s, n[0], n[1], n[2]);
+		XMVectorSinCos(&s, &c, angles[1] + angles[2]);
+		Rotate(JointAxis::Z, c, -s, n[0], n[1], n[2]);
+		XMVECTOR cos4 = XMVectorClamp(n[0], -one, one);
+		XMVECTOR sin4 = XMVectorSqrt((one - cos4) * (one + cos4));
+		angles[4] = wristSign * VectorACos(cos4);
+		// odwrocony nadgarstek: a3 + pi sprowadzone do [-pi, pi]
+		XMVECTOR a3 = VectorATan2(n[2], n[1]);
+		XMVECTOR turned = a3 + XMVectorSelect(XMVectorReplicate(-XM_PI), XMVectorReplicate(XM_PI), XMVectorLessOrEqual(a3, zero));
+		angles[3] = XMVectorSelect(a3, turned, XMVectorLess(wristSign, zero));
+
+		conditioning = XMVectorMin(XMVectorMin(XMVectorAbs(sin2), sin4),
+			XMVectorMin(e * XMVectorReplicate(1.f / (l1 + l2)), one));
+	}
+}
+
+void JointBatch::resize(size_t n)
+{
+	for (auto& a : angles)
+		a.resize(Padded<KinematicsBlock>(n), 0.f);
+	count = n;
+}
+
+void ToolBatch::resize(size_t n)
+{
+	for (auto* a : { &px, &py, &pz, &nx, &ny, &nz })
+		a->resize(Padded<KinematicsBlock>(n));
+	count = n;
+}
+
+PumaKinematics::PumaKinematics(const PumaLinks& links)
+	: m_links(links)
+{
+	const float h = links.shoulderHeight, elbow = links.upperArm, wrist = links.upperArm + links.forearm;
+	// podstawa, ramie, lokiec, obrot przedramienia, nadgarstek
+	m_joints[0] = { JointAxis::Y, { 0.f, 0.f, 0.f } };
+	m_joints[1] = { JointAxis::Z, { 0.f, h, 0.f } };
+	m_joints[2] = { JointAxis::Z, { -elbow, h, 0.f } };
+	m_joints[3] = { JointAxis::X, { 0.f, h, -links.wristOffset } };
+	m_joints[4] = { JointAxis::Z, { -wrist, h, 0.f } };
+	// narzedzie na osi przedramienia, normalna od konca narzedzia do nadgarstka
+	m_restPosition = { -(wrist + links.tool), h, -links.wristOffset };
+	m_restNormal = { 1.f, 0.f, 0.f };
+}
+
+void PumaKinematics::LinkMatrices(const float angles[PumaJointCount], XMFLOAT4X4 links[PumaLinkCount]) const
+{
+	XMMATRIX m = XMMatrixIdentity();
+	XMStoreFloat4x4(&links[0], m);
+	for (size_t j = 0; j < PumaJointCount; ++j)
+	{
+		XMVECTOR pivot = XMLoadFloat3(&m_joints[j].pivot);
+		m = XMMatrixTranslationFromVector(-pivot) * Rotation(m_joints[j].axis, angles[j]) * XMMatrixTranslationFromVector(pivot) * m;
+		XMStoreFloat4x4(&links[j + 1], m);
+	}
+}
+
+void PumaKinematics::ForwardKinematics(const float angles[PumaJointCount], XMFLOAT3& position, XMFLOAT3& normal) const
+{
+	float c[PumaJointCount], s[PumaJointCount];
+	for (size_t j = 0; j < PumaJointCount; ++j)
+	{
+		c[j] = cosf(angles[j]);
+		s[j] = sinf(angles[j]);
+	}
+	float p[3] = { m_restPosition.x, m_restPosition.y, m_restPosition.z };
+	float n[3] = { m_restNormal.x, m_restNormal.y, m_restNormal.z };
+	MoveTool(m_joints, c, s, p, n);
+	position = { p[0], p[1], p[2] };
+	normal = { n[0], n[1], n[2] };
+}
+
+void PumaKinematics::ForwardKinematics(const JointBatch& angles, ToolBatch& tools) const
+{
+	tools.resize(angles.count);
+	ForwardKinematics(angles, 0, angles.count, tools);
+}
+
+void PumaKinematics::ForwardKinematics(const JointBatch& angles, size_t first, size_t count, ToolBatch& tools) const
+{
+	auto scalar = [&](size_t from, size_t to)
+	{
+		for (size_t i = from; i < to; ++i)
+		{
+			float a[PumaJointCount];
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				a[j] = angles.angles[j][i];
+			XMFLOAT3 p, n;
+			ForwardKinematics(a, p, n);
+			tools.px[i] = p.x; tools.py[i] = p.y; tools.pz[i] = p.z;
+			tools.nx[i] = n.x; tools.ny[i] = n.y; tools.nz[i] = n.z;
+		}
+	};
+	auto blocks = [&](size_t begin, size_t end)
+	{
+		const XMVECTOR restPosition[3] = { XMVectorReplicate(m_restPosition.x), XMVectorReplicate(m_restPosition.y),
+			XMVectorReplicate(m_restPosition.z) };
+		const XMVECTOR restNormal[3] = { XMVectorReplicate(m_restNormal.x), XMVectorReplicate(m_restNormal.y),
+			XMVectorReplicate(m_restNormal.z) };
+		for (size_t i = begin; i < end; i += KinematicsBlock)
+		{
+			XMVECTOR c[PumaJointCount], s[PumaJointCount];
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				XMVectorSinCos(&s[j], &c[j], LoadBlock(angles.angles[j], i));
+			XMVECTOR p[3] = { restPosition[0], restPosition[1], restPosition[2] };
+			XMVECTOR n[3] = { restNormal[0], restNormal[1], restNormal[2] };
+			MoveTool(m_joints, c, s, p, n);
+			StoreBlock(tools.px, i, p[0]);
+			StoreBlock(tools.py, i, p[1]);
+			StoreBlock(tools.pz, i, p[2]);
+			StoreBlock(tools.nx, i, n[0]);
+			StoreBlock(tools.ny, i, n[1]);
+			StoreBlock(tools.nz, i, n[2]);
+		}
+	};
+	SplitRange<KinematicsBlock>(first, first + count, angles.count, scalar, blocks);
+}
+
+bool PumaKinematics::InverseKinematics(XMFLOAT3 pos, XMFLOAT3 normal, float angles[PumaJointCount]) const
+{
+	const float l1 = m_links.upperArm, l2 = m_links.forearm, l3 = m_links.tool;
+	const float dy = m_links.shoulderHeight, dz = m_links.wristOffset;
+
+	XMVECTOR nor = XMVector3Normalize(XMLoadFloat3(&normal));
+	XMVECTOR p1 = XMLoadFloat3(&pos) + nor * l3;
+	XMFLOAT3 p1f;
+	XMStoreFloat3(&p1f, p1);
+
+	// nadgarstek blizej osi podstawy niz przesuniecie dz - nieosiagalny
+	float e2 = p1f.x * p1f.x + p1f.z * p1f.z - dz * dz;
+	bool reachable = e2 >= 0.f;
+	float e = sqrtf(max(0.f, e2));
+	angles[0] = atan2f(p1f.z, -p1f.x) + atan2f(dz, e);
+
+	float y = p1f.y - dy;
+	float cos2 = (e * e + y * y - l1 * l1 - l2 * l2) / (2.0f * l1 * l2);
+	reachable = reachable && fabsf(cos2) <= 1.f + ReachTolerance;
+	angles[2] = -acosf(max(-1.f, min(1.f, cos2)));
+
+	float k = l1 + l2 * cosf(angles[2]);
+	float l = l2 * sinf(angles[2]);
+	angles[1] = -atan2f(y, e) - atan2f(l, k);
+
+	XMVECTOR normal1 = XMVector3TransformNormal(nor, XMMatrixRotationY(-angles[0]));
+	normal1 = XMVector3TransformNormal(normal1, XMMatrixRotationZ(-(angles[1] + angles[2])));
+	XMFLOAT3 n1;
+	XMStoreFloat3(&n1, normal1);
+	angles[4] = acosf(max(-1.f, min(1.f, n1.x)));
+	angles[3] = atan2f(n1.z, n1.y);
+	return reachable;
+}
+
+void PumaKinematics::InverseKinematics(const ToolBatch& targets, JointBatch& angles, vector<uint8_t>& reachable) const
+{
+	angles.resize(targets.count);
+	reachable.resize(targets.count);
+	InverseKinematics(targets, 0, targets.count, angles, reachable);
+}
+
+void PumaKinematics::InverseKinematics(const ToolBatch& targets, size_t first, size_t count, JointBatch& angles,
+	vector<uint8_t>& reachable) const
+{
+	auto scalar = [&](size_t from, size_t to)
+	{
+		for (size_t i = from; i < to; ++i)
+		{
+			float a[PumaJointCount];
+			reachable[i] = InverseKinematics({ targets.px[i], targets.py[i], targets.pz[i] },
+				{ targets.nx[i], targets.ny[i], targets.nz[i] }, a);
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				angles.angles[j][i] = a[j];
+		}
+	};
+	auto blocks = [&](size_t begin, size_t end)
+	{
+		const XMVECTOR one = XMVectorSplatOne(), tool = XMVectorReplicate(m_links.tool);
+		for (size_t i = begin; i < end; i += KinematicsBlock)
+		{
+			XMVECTOR n[3] = { LoadBlock(targets.nx, i), LoadBlock(targets.ny, i), LoadBlock(targets.nz, i) };
+			XMVECTOR invLength = one / XMVectorSqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (XMVECTOR& v : n)
+				v = v * invLength;
+			const XMVECTOR p[3] = { XMVectorMultiplyAdd(n[0], tool, LoadBlock(targets.px, i)),
+				XMVectorMultiplyAdd(n[1], tool, LoadBlock(targets.py, i)), XMVectorMultiplyAdd(n[2], tool, LoadBlock(targets.pz, i)) };
+			XMVECTOR a[PumaJointCount], reach, conditioning;
+			SolveBlock(m_links, p, n, one, -one, one, a, reach, conditioning);
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				StoreBlock(angles.angles[j], i, a[j]);
+			uint32_t mask[KinematicsBlock];
+			XMStoreInt4(mask, reach);
+			// pasy dopelnienia za ostatnim celem nie maja miejsca w reachable
+			for (size_t j = 0; j < KinematicsBlock && i + j < targets.count; ++j)
+				reachable[i + j] = mask[j] ? 1 : 0;
+		}
+	};
+	SplitRange<KinematicsBlock>(first, first + count, targets.count, scalar, blocks);
+}
+
+bool PumaKinematics::InverseKinematicsBranches(XMFLOAT3 position, XMFLOAT3 normal, IkSolution solutions[PumaBranchCount]) const
+{
+	XMVECTOR nor = XMVector3Normalize(XMLoadFloat3(&normal));
+	XMVECTOR wrist = XMLoadFloat3(&position) + nor * m_links.tool;
+	// galezie 0-3 i 4-7 w pasach dwoch wektorow
+	const XMVECTOR wristSign = XMVectorSet(1.f, -1.f, 1.f, -1.f), elbowSign = XMVectorSet(-1.f, -1.f, 1.f, 1.f);
+	bool reachable = true;
+	for (size_t half = 0; half < 2; ++half)
+	{
+		const XMVECTOR p[3] = { XMVectorSplatX(wrist), XMVectorSplatY(wrist), XMVectorSplatZ(wrist) };
+		XMVECTOR n[3] = { XMVectorSplatX(nor), XMVectorSplatY(nor), XMVectorSplatZ(nor) };
+		XMVECTOR a[PumaJointCount], reach, conditioning;
+		SolveBlock(m_links, p, n, XMVectorReplicate(half ? -1.f : 1.f), elbowSign, wristSign, a, reach, conditioning);
+		XMFLOAT4 lanes[PumaJointCount], cond;
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			XMStoreFloat4(&lanes[j], a[j]);
+		XMStoreFloat4(&cond, conditioning);
+		uint32_t mask[4];
+		XMStoreInt4(mask, reach);
+		reachable = reachable && mask[0];
+		for (size_t lane = 0; lane < 4; ++lane)
+		{
+			IkSolution& solution = solutions[4 * half + lane];
+			solution.branch = static_cast<unsigned>(4 * half + lane);
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				solution.angles[j] = (&lanes[j].x)[lane];
+			solution.conditioning = (&cond.x)[lane];
+		}
+	}
+	return reachable;
+}
+
+bool PumaKinematics::NearestInverseKinematics(XMFLOAT3 position, XMFLOAT3 normal, const float previous[PumaJointCount],
+	IkSolution& solution) const
+{
+	IkSolution solutions[PumaBranchCount];
+	bool reachable = InverseKinematicsBranches(position, normal, solutions);
+	// previous moze wskazywac na solution.angles
+	float last[PumaJointCount];
+	copy(previous, previous + PumaJointCount, last);
+	float best = numeric_limits<float>::infinity();
+	for (IkSolution& s : solutions)
+	{
+		// najblizszy obrot o wielokrotnosc 2 pi
+		float distance = 0.f;
+		for (size_t j = 0; j < PumaJointCount; ++j)
+		{
+			float d = remainderf(s.angles[j] - last[j], XM_2PI);
+			s.angles[j] = last[j] + d;
+			distance += d * d;
+		}
+		if (distance < best)
+		{
+			best = distance;
+			solution = s;
+		}
+	}
+	return reachable;
+}
+
+DlsResult PumaKinematics::DampedLeastSquares(XMFLOAT3 position, XMFLOAT3 normal, float angles[PumaJointCount],
+	const DlsSettings& settings, DlsStats* stats) const
+{
+	const auto start = chrono::steady_clock::now();
+	const XMVECTOR target = XMLoadFloat3(&position);
+	const XMVECTOR targetNormal = XMVector3Normalize(XMLoadFloat3(&normal));
+	const XMVECTOR restPosition = XMLoadFloat3(&m_restPosition), restNormal = XMLoadFloat3(&m_restNormal);
+	const float w = settings.normalWeight;
+
+	DlsResult result = { 0, numeric_limits<float>::infinity(), false };
+	float best[PumaJointCount];
+	copy(angles, angles + PumaJointCount, best);
+	for (unsigned iteration = 0;; ++iteration)
+	{
+		XMFLOAT4X4 links[PumaLinkCount];
+		LinkMatrices(angles, links);
+		XMMATRIX toolMtx = XMLoadFloat4x4(&links[PumaJointCount]);
+		XMVECTOR p = XMVector3TransformCoord(restPosition, toolMtx);
+		XMVECTOR n = XMVector3TransformNormal(restNormal, toolMtx);
+		XMVECTOR dp = target - p, dn = targetNormal - n;
+		float error = sqrtf(XMVectorGetX(XMVector3LengthSq(dp)) + w * w * XMVectorGetX(XMVector3LengthSq(dn)));
+		// kroki DLS nie zawsze zmniejszaja blad - zostaje najlepsza konfiguracja
+		if (error < result.error)
+		{
+			result.error = error;
+			copy(angles, angles + PumaJointCount, best);
+		}
+		if (error <= settings.tolerance)
+		{
+			result.converged = true;
+			break;
+		}
+		if (iteration == settings.maxIterations)
+			break;
+		result.iterations = iteration + 1;
+
+		// daleki cel - krok skrocony, przyblizenie liniowe jest lokalne
+		float length = XMVectorGetX(XMVector3Length(dp));
+		if (length > settings.maxStep)
+			dp *= settings.maxStep / length;
+		// kolumny jakobianu: a x (p - q) dla czubka narzedzia i w (a x n) dla normalnej,
+		// a i q to os i punkt obrotu przegubu po obrotach przegubow blizszych podstawie
+		float jacobian[PumaJointCount][6];
+		for (size_t j = 0; j < PumaJointCount; ++j)
+		{
+			XMMATRIX m = XMLoadFloat4x4(&links[j]);
+			XMVECTOR axis = XMVector3TransformNormal(AxisVector(m_joints[j].axis), m);
+			XMVECTOR pivot = XMVector3TransformCoord(XMLoadFloat3(&m_joints[j].pivot), m);
+			XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&jacobian[j][0]), XMVector3Cross(axis, p - pivot));
+			XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&jacobian[j][3]), XMVector3Cross(axis, n) * w);
+		}
+		float e[6];
+		XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&e[0]), dp);
+		XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&e[3]), dn * w);
+
+		// (J^T J + lambda^2 I) da = J^T e, tlumienie maleje z bledem (Levenberg-Marquardt) - blisko celu
+		// zbieznosc jak metody Newtona, a w poblizu osobliwosci krok nie rosnie ponad blad / (2 lambda)
+		const float damping = settings.damping, floor = 0.1f * damping;
+		const float lambda2 = min(damping * damping, error * error + floor * floor);
+		float a[PumaJointCount][PumaJointCount], step[PumaJointCount];
+		for (size_t i = 0; i < PumaJointCount; ++i)
+		{
+			for (size_t j = 0; j <= i; ++j)
+			{
+				float dot = 0.f;
+				for (size_t k = 0; k < 6; ++k)
+					dot += jacobian[i][k] * jacobian[j][k];
+				a[i][j] = a[j][i] = dot;
+			}
+			a[i][i] += lambda2;
+			step[i] = 0.f;
+			for (size_t k = 0; k < 6; ++k)
+				step[i] += jacobian[i][k] * e[k];
+		}
+		SolvePositiveDefinite<PumaJointCount>(a, step);
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			angles[j] += step[j];
+	}
+	copy(best, best + PumaJointCount, angles);
+
+	if (stats)
+	{
+		++stats->solves;
+		stats->iterations += result.iterations;
+		stats->converged += result.converged;
+		stats->seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+	return result;
+}
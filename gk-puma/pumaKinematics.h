@@ -0,0 +1,165 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+//Kinematic model of the Puma manipulator independent of rendering: link dimensions,
+//joint axes through pivots in the rest pose (the pose of the mesh files) and forward
+//and inverse kinematics of single configurations and of structure-of-arrays batches.
+
+namespace mini
+{
+	constexpr size_t PumaJointCount = 5;
+	//Base and the links moved by each joint
+	constexpr size_t PumaLinkCount = PumaJointCount + 1;
+
+	//Dimensions of the arm, the arm points in -x in the rest pose
+	struct PumaLinks
+	{
+		//Height of the shoulder, elbow and wrist axes above the base
+		float shoulderHeight = 0.27f;
+		//Shoulder to elbow
+		float upperArm = 0.91f;
+		//Elbow to wrist
+		float forearm = 0.81f;
+		//Offset of the wrist from the plane of the arm (in -z in the rest pose)
+		float wristOffset = 0.26f;
+		//Wrist to tool tip
+		float tool = 0.33f;
+	};
+
+	enum class JointAxis { X, Y, Z };
+
+	//Rotation about an axis parallel to a coordinate axis, through pivot (rest pose)
+	struct PumaJoint
+	{
+		JointAxis axis;
+		DirectX::XMFLOAT3 pivot;
+	};
+
+	//Analytic inverse kinematics solutions of one target. Bit 0 of the branch flips the wrist
+	//(a4 -> -a4, a3 -> a3 + pi), bit 1 bends the elbow the other way, bit 2 turns the base
+	//so that the arm reaches backwards over the shoulder. Branch 0 is the application's.
+	constexpr size_t PumaBranchCount = 8;
+
+	struct IkSolution
+	{
+		float angles[PumaJointCount];
+		unsigned branch;
+		//Smallest of |sin a4| (wrist), |sin a2| (elbow) and the distance of the wrist from the base axis
+		//relative to upperArm + forearm (shoulder), in [0, 1]. Branches merge at 0, where the angles
+		//stop being unique (a3 at the wrist) and small target moves need large joint moves.
+		float conditioning;
+	};
+
+	//Settings of the iterative damped least squares solver
+	struct DlsSettings
+	{
+		//Iterations of one solve, the solver stops early at tolerance
+		unsigned maxIterations = 12;
+		//lambda in (J^T J + lambda^2 I)^-1 J^T e: bounds the joint steps where the Jacobian loses rank
+		float damping = 0.05f;
+		//Weight of the normal error relative to the tool tip error in meters
+		float normalWeight = 0.3f;
+		//Longest tool tip error corrected in one step, so that far targets are approached in straight lines
+		float maxStep = 0.2f;
+		//Weighted error at which a solve has converged
+		float tolerance = 1e-5f;
+	};
+
+	struct DlsResult
+	{
+		unsigned iterations;
+		//Weighted error of the returned angles, sqrt(|dp|^2 + (normalWeight |dn|)^2)
+		float error;
+		bool converged;
+	};
+
+	//Accumulated over many solves, for budgeting the solver in the frame
+	struct DlsStats
+	{
+		size_t solves = 0;
+		size_t iterations = 0;
+		size_t converged = 0;
+		double seconds = 0.0;
+
+		double AverageIterations() const { return solves ? static_cast<double>(iterations) / solves : 0.0; }
+		double AverageMicroseconds() const { return solves ? 1e6 * seconds / solves : 0.0; }
+	};
+
+	//Number of configurations evaluated together by the batch kernels; batches are padded to it
+	constexpr size_t KinematicsBlock = 4;
+
+	//Joint angles of many configurations, one array per joint
+	struct JointBatch
+	{
+		std::vector<float> angles[PumaJointCount];
+		size_t count = 0;
+
+		//Padding configurations are all zeros
+		void resize(size_t count);
+	};
+
+	//Tool tip positions and normals (the direction from the tip to the wrist),
+	//results of forward kinematics and targets of inverse kinematics
+	struct ToolBatch
+	{
+		std::vector<float> px, py, pz, nx, ny, nz;
+		size_t count = 0;
+
+		void resize(size_t count);
+	};
+
+	class PumaKinematics
+	{
+	public:
+		explicit PumaKinematics(const PumaLinks& links = {});
+
+		const PumaLinks& Links() const { return m_links; }
+		const PumaJoint& Joint(size_t i) const { return m_joints[i]; }
+		//Tool tip and normal in the rest pose
+		DirectX::XMFLOAT3 RestToolPosition() const { return m_restPosition; }
+		DirectX::XMFLOAT3 RestToolNormal() const { return m_restNormal; }
+
+		//World matrices of the base and the links moved by each joint
+		void LinkMatrices(const float angles[PumaJointCount], DirectX::XMFLOAT4X4 links[PumaLinkCount]) const;
+		//Tool tip position and normal of one configuration
+		void ForwardKinematics(const float angles[PumaJointCount], DirectX::XMFLOAT3& position, DirectX::XMFLOAT3& normal) const;
+		//Tool poses of all configurations, KinematicsBlock at a time with DirectXMath vectors
+		void ForwardKinematics(const JointBatch& angles, ToolBatch& tools) const;
+		//Configurations first .. first + count - 1; tools must already be resized to angles.count
+		void ForwardKinematics(const JointBatch& angles, size_t first, size_t count, ToolBatch& tools) const;
+
+		//Closed form angles placing the tool tip at position with the given (non-zero) normal, on the branch
+		//used by the application. Returns false if the target is out of reach; the arm is then stretched
+		//or folded towards it and the angles stay finite.
+		bool InverseKinematics(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 normal, float angles[PumaJointCount]) const;
+		//All targets at once, KinematicsBlock at a time with VectorATan2 and VectorACos (angles within
+		//a few VectorTrigMaxError of the single target solution). reachable[i] is 1 or 0.
+		void InverseKinematics(const ToolBatch& targets, JointBatch& angles, std::vector<uint8_t>& reachable) const;
+		//Targets first .. first + count - 1; angles and reachable must already be resized to targets.count
+		void InverseKinematics(const ToolBatch& targets, size_t first, size_t count, JointBatch& angles,
+			std::vector<uint8_t>& reachable) const;
+
+		//All branches of the target, evaluated at once in the lanes of two vectors (angles within
+		//a few VectorTrigMaxError). solutions[b] is branch b. Returns false if the target is out of reach.
+		bool InverseKinematicsBranches(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 normal,
+			IkSolution solutions[PumaBranchCount]) const;
+		//Branch closest to previous in joint space, with every angle moved by a multiple of 2 pi
+		//next to its previous value, so that the arm follows a moving target without flipping
+		bool NearestInverseKinematics(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 normal,
+			const float previous[PumaJointCount], IkSolution& solution) const;
+
+		//Damped least squares iterations with the analytic Jacobian of the joint chain, starting from angles
+		//(usually the previous frame) and leaving the best configuration found in them. Unreachable targets
+		//and singular poses end with the arm pointing at the target and converged false, never with jumps.
+		//Iterations and time are added to stats if given.
+		DlsResult DampedLeastSquares(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 normal, float angles[PumaJointCount],
+			const DlsSettings& settings = {}, DlsStats* stats = nullptr) const;
+
+	private:
+		PumaLinks m_links;
+		PumaJoint m_joints[PumaJointCount];
+		DirectX::XMFLOAT3 m_restPosition, m_restNormal;
+	};
+}
@@ -0,0 +1,120 @@
+#include "pumaSimulation.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+using namespace mini;
+using namespace gk2;
+using namespace DirectX;
+using namespace std;
+
+unsigned int FixedStepClock::Advance(double frameTime)
+{
+	m_accumulator += frameTime;
+	unsigned int steps = static_cast<unsigned int>(m_accumulator / m_step);
+	if (steps > m_maxSteps)
+	{
+		// symulacja nie nadaza - nadmiar czasu jest pomijany zamiast narastac
+		steps = m_maxSteps;
+		m_accumulator = m_maxSteps * m_step;
+	}
+	m_accumulator = max(0.0, m_accumulator - steps * m_step);
+	m_steps += steps;
+	return steps;
+}
+
+XMFLOAT4X4 gk2::SceneMirrorMtx()
+{
+	XMFLOAT4X4 mtx;
+	XMStoreFloat4x4(&mtx, XMMatrixRotationY(XM_PIDIV2) * XMMatrixRotationZ(XM_PIDIV4) * XMMatrixTranslation(-1.5f, 0.25f, -0.5f));
+	return mtx;
+}
+
+PumaSimulation::PumaSimulation(const XMFLOAT4X4& mirrorMtx, unsigned int seed)
+	: m_mirrorMtx(mirrorMtx), m_particles({ 0.0f, 0.0f, 0.0f }, seed)
+{ }
+
+void PumaSimulation::Step(float dt, const ManipulatorInput& input)
+{
+	copy(begin(m_angles), end(m_angles), m_previousAngles);
+	if (any_of(begin(input.jointVelocity), end(input.jointVelocity), [](float v) { return v != 0.f; }))
+	{
+		m_animation = false;
+		// ustawienie reczne jest poprzednia pozycja dla animacji
+		m_ikSeeded = true;
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			m_angles[j] += input.jointVelocity[j] * dt;
+	}
+	if (m_animation)
+	{
+		Animate(dt);
+		m_particles.Update(dt);
+	}
+}
+
+void PumaSimulation::Animate(float dt)
+{
+	const float r = 0.4f;
+	m_animationTime += dt;
+	const float t = static_cast<float>(m_animationTime);
+	XMFLOAT3 pos = { r * cosf(t), r * sinf(t), 0.f };
+	XMFLOAT3 normal = { 0.f, 0.f, -1.f };
+
+	XMVECTOR p = XMLoadFloat3(&pos);
+	XMVECTOR n = XMLoadFloat3(&normal);
+
+	XMMATRIX mirror = XMLoadFloat4x4(&m_mirrorMtx);
+	XMMATRIX invmirror = XMMatrixInverse(nullptr, mirror);
+
+	XMVECTOR p3 = XMVector3TransformCoord(p, mirror);
+	XMVECTOR n3 = XMVector3TransformNormal(n, invmirror);
+
+	XMStoreFloat3(&pos, p3);
+	XMStoreFloat3(&normal, n3);
+
+	InverseKinematics(pos, normal);
+	m_particles.SetEmitterPosition(pos);
+}
+
+void PumaSimulation::InverseKinematics(XMFLOAT3 pos, XMFLOAT3 normal)
+{
+	// pierwsze rozwiazanie - zerowe katy nie sa poprzednia pozycja, ramie startuje z galezi 0
+	if (!m_ikSeeded)
+	{
+		m_ikSeeded = true;
+		if (m_kinematics.InverseKinematics(pos, normal, m_angles))
+			return;
+		m_kinematics.DampedLeastSquares(pos, normal, m_angles, {}, &m_ikStats);
+		return;
+	}
+	// galaz najblizsza poprzedniemu krokowi - ramie nie przeskakuje przy osobliwosciach
+	const float singular = 1e-2f;
+	IkSolution solution;
+	bool reachable = m_kinematics.NearestInverseKinematics(pos, normal, m_angles, solution);
+	if (reachable && solution.conditioning > singular)
+	{
+		copy(begin(solution.angles), end(solution.angles), m_angles);
+		return;
+	}
+	// cel nieosiagalny albo osobliwy - iteracje DLS od poprzedniego kroku, ramie wyciaga sie w strone celu;
+	// nieosiagalny zaczyna od najblizszej galezi wyprostowanej w strone celu, co tlumi drgania kolejnych wynikow DLS.
+	// Po powrocie do zasiegu galaz najblizsza wynikowi DLS, bez przeskoku do galezi 0
+	if (!reachable)
+		copy(begin(solution.angles), end(solution.angles), m_angles);
+	m_kinematics.DampedLeastSquares(pos, normal, m_angles, {}, &m_ikStats);
+}
+
+void PumaSimulation::LinkMatrices(float alpha, XMFLOAT4X4 links[PumaLinkCount]) const
+{
+	// katy sa ciagle (najblizsza galaz), wiec interpolacja liniowa nie obraca ramienia o 2 pi
+	float angles[PumaJointCount];
+	for (size_t j = 0; j < PumaJointCount; ++j)
+		angles[j] = m_previousAngles[j] + alpha * (m_angles[j] - m_previousAngles[j]);
+	m_kinematics.LinkMatrices(angles, links);
+}
+
+vector<ParticleVertex> PumaSimulation::ParticleVertices(XMFLOAT4 cameraPosition, float alpha) const
+{
+	// zatrzymane czastki stoja w ostatnim polozeniu
+	return m_particles.GetParticleVerts(cameraPosition, m_animation ? alpha : 1.0f);
+}
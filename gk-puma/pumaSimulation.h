@@ -0,0 +1,94 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "particleSystem.h"
+#include "pumaKinematics.h"
+
+//Simulation of the scene advanced in fixed steps, independent of the frame rate: the arm (manual
+//control or the animation drawing a circle on the mirror) and the particles emitted by its tool.
+//Rendering runs at its own rate and places the state between the last two steps.
+
+namespace mini
+{
+	namespace gk2
+	{
+		//Accumulates frame times and converts them to a whole number of fixed steps
+		class FixedStepClock
+		{
+		public:
+			static constexpr double DefaultStep = 1.0 / 120.0;
+			//Steps simulated after one frame at most, longer frames (breakpoints, window dragging) slow the simulation down
+			static constexpr unsigned int DefaultMaxSteps = 8;
+
+			explicit FixedStepClock(double step = DefaultStep, unsigned int maxSteps = DefaultMaxSteps)
+				: m_step(step), m_maxSteps(maxSteps)
+			{ }
+
+			//Adds the frame time and returns the number of steps to simulate
+			unsigned int Advance(double frameTime);
+			double Step() const { return m_step; }
+			//Time left in the accumulator as a fraction of the step, in [0, 1)
+			float Alpha() const { return static_cast<float>(m_accumulator / m_step); }
+			uint64_t Steps() const { return m_steps; }
+
+		private:
+			double m_step;
+			unsigned int m_maxSteps;
+			double m_accumulator = 0.0;
+			uint64_t m_steps = 0;
+		};
+
+		//Placement of the mirror in the scene
+		DirectX::XMFLOAT4X4 SceneMirrorMtx();
+
+		//Manual control held during the steps of a frame
+		struct ManipulatorInput
+		{
+			//Joint velocities in radians per second, any non-zero velocity stops the animation
+			float jointVelocity[PumaJointCount] = {};
+		};
+
+		class PumaSimulation
+		{
+		public:
+			//The tool tip of the animation draws a circle in the plane of the mirror placed by mirrorMtx.
+			//The same seed and the same steps give bit-identical arm and particles.
+			explicit PumaSimulation(const DirectX::XMFLOAT4X4& mirrorMtx, unsigned int seed = 0);
+
+			void Step(float dt, const ManipulatorInput& input = {});
+
+			bool Animation() const { return m_animation; }
+			void SetAnimation(bool animation) { m_animation = animation; }
+			const float* Angles() const { return m_angles; }
+			const PumaKinematics& Kinematics() const { return m_kinematics; }
+			const ParticleSystem& Particles() const { return m_particles; }
+
+			//Link matrices of the arm between the previous (alpha = 0) and the last step (alpha = 1)
+			void LinkMatrices(float alpha, DirectX::XMFLOAT4X4 links[PumaLinkCount]) const;
+			//Particle vertices between the last two steps, sorted back to front
+			std::vector<ParticleVertex> ParticleVertices(DirectX::XMFLOAT4 cameraPosition, float alpha) const;
+
+			//Iterative inverse kinematics solves since the last reset
+			const DlsStats& IkStats() const { return m_ikStats; }
+			void ResetIkStats() { m_ikStats = {}; }
+
+		private:
+			void Animate(float dt);
+			void InverseKinematics(DirectX::XMFLOAT3 pos, DirectX::XMFLOAT3 normal);
+
+			PumaKinematics m_kinematics;
+			DirectX::XMFLOAT4X4 m_mirrorMtx;
+			float m_angles[PumaJointCount] = {};
+			float m_previousAngles[PumaJointCount] = {};
+			bool m_animation = true;
+			//Time of the animation, stopped together with it
+			double m_animationTime = 0.0;
+			ParticleSystem m_particles;
+			DlsStats m_ikStats;
+			//Set once the angles are a pose of the arm (first solve or manual control); the first solve
+			//takes branch 0, later ones the branch nearest to the previous step
+			bool m_ikSeeded = false;
+		};
+	}
+}
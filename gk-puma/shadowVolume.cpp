@@ -0,0 +1,246 @@
+#include "shadowVolume.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+void ShadowCaster::PrepareSilhouetteData()
+{
+	// pozycja kazdego wierzcholka - wierzcholki o tej samej pozycji (rozne normalne)
+	// dziela wierzcholki bryly cienia
+	vector<unsigned> vertexPositions = MatchPositions(positions, vertices);
+	for (unsigned p : vertexPositions)
+		if (p == UINT32_MAX)
+			throw invalid_argument("Shadow caster vertex does not match any position");
+	m_meshlets.clear();
+	prepare(move(vertexPositions));
+}
+
+AdjacencyStats ShadowCaster::BuildAdjacency(float weldTolerance, bool closeBoundaries)
+{
+	// pozycje po zespawaniu moga roznic sie od wierzcholkow - przypisanie z WeldPositions
+	WeldedPositions welded = WeldPositions(vertices, weldTolerance);
+	positions = move(welded.positions);
+	AdjacencyStats stats;
+	edges = BuildEdges(faces, welded.vertexPositions, &stats);
+	if (closeBoundaries)
+		stats.closingFaces = CloseBoundaries(faces, edges);
+	m_meshlets.clear();
+	prepare(move(welded.vertexPositions));
+	return stats;
+}
+
+void ShadowCaster::BuildMeshlets(unsigned maxFaces)
+{
+	// nowa kolejnosc scian i krawedzi - dane sylwetki przygotowywane od nowa
+	m_meshlets = mini::BuildMeshlets(vertices, faces, edges, maxFaces);
+	prepare(move(m_vertexPositions));
+}
+
+bool ShadowCaster::PrepareMesh()
+{
+	// siatki bez krawedzi (generowane, importowane) dostaja sasiedztwo odtworzone z trojkatow;
+	// otwarte brzegi krawedzi z pliku sa zamykane
+	const size_t drawnFaces = faces.size();
+	if (edges.empty())
+		BuildAdjacency();
+	else
+	{
+		CloseBoundaries(faces, edges);
+		PrepareSilhouetteData();
+	}
+	// sciany zamykajace nie sa rysowane, wiec meshlety tylko dla siatek zamknietych
+	if (faces.size() != drawnFaces)
+		return false;
+	BuildMeshlets();
+	return true;
+}
+
+ShadowCaster ShadowCaster::Simplified(size_t targetFaceCount, float* error) const
+{
+	// cien zalezy tylko od pozycji - normalne i podzial wierzcholkow pomijane
+	vector<Face> positionFaces(faces);
+	for (Face& face : positionFaces)
+		for (unsigned& v : face.indices)
+			v = m_vertexPositions[v];
+	SimplifiedMesh simplified = SimplifyMesh(positions, positionFaces, targetFaceCount);
+	if (error)
+		*error = simplified.error;
+	ShadowCaster result;
+	result.positions = simplified.positions;
+	result.vertices = move(simplified.positions);
+	result.faces = move(simplified.faces);
+	result.BuildAdjacency();
+	return result;
+}
+
+void ShadowCaster::prepare(vector<unsigned> vertexPositions)
+{
+	// otwarta krawedz (face1 == UINT_MAX) dalaby niezamknieta bryle cienia
+	for (const Edge& e : edges)
+		if (e.face1 == UINT_MAX)
+			throw invalid_argument("Shadow caster edge has a single face");
+	m_vertexPositions = move(vertexPositions);
+	m_facePlanes.Build(vertices, faces);
+	m_edgeFaces.Build(edges);
+	m_faceEdges.Build(edges, faces.size());
+
+	// srodek prostopadloscianu otaczajacego - punkt odniesienia dla kierunku swiatla
+	XMVECTOR minP = XMVectorReplicate(FLT_MAX), maxP = XMVectorReplicate(-FLT_MAX);
+	for (const auto& p : positions) {
+		minP = XMVectorMin(minP, XMLoadFloat3(&p));
+		maxP = XMVectorMax(maxP, XMLoadFloat3(&p));
+	}
+	XMStoreFloat3(&m_center, positions.empty() ? XMVectorZero() : (minP + maxP) * 0.5f);
+}
+
+bool ShadowCaster::isEdgeOriented(unsigned v0, unsigned v1, const Face& face) const
+{
+	for (int i = 0; i < 3; ++i) {
+		unsigned a = m_vertexPositions[face.indices[i]];
+		unsigned b = m_vertexPositions[face.indices[(i + 1) % 3]];
+		if (a == v0 && b == v1)
+			return true;
+		if (a == v1 && b == v0)
+			return false;
+	}
+	return true;
+}
+
+XMVECTOR ShadowCaster::extrude(FXMVECTOR pos, FXMVECTOR lightPos, CXMMATRIX worldMtx, float extrusionDistance)
+{
+	// kierunek swiatla w ukladzie obiektu
+	XMVECTOR dir = XMVectorSetW(pos - lightPos, 0.f);
+	// punkt w nieskonczonosci (w = 0)
+	if (extrusionDistance == InfiniteExtrusion)
+		return dir;
+	// przeskalowany tak, by w ukladzie swiata wierzcholek przesunal sie dokladnie o extrusionDistance
+	XMVECTOR worldLength = XMVector3Length(XMVector3TransformNormal(dir, worldMtx));
+	return XMVectorSetW(pos + dir * (XMVectorReplicate(extrusionDistance) / worldLength), 1.f);
+}
+
+void ShadowCaster::GenerateShadowVolume(ShadowVolume& volume, XMFLOAT3 lightPos, const XMFLOAT4X4& worldMtx, float extrusionDistance, VolumeSpace space) const
+{
+	volume.clear();
+
+	// swiatlo przenoszone do ukladu obiektu - wierzcholki siatki nie sa transformowane
+	XMMATRIX m = XMLoadFloat4x4(&worldMtx);
+	XMVECTOR det;
+	XMMATRIX invM = XMMatrixInverse(&det, m);
+	XMVECTOR lightPosV = XMVector3Transform(XMLoadFloat3(&lightPos), invM);
+	XMFLOAT3 objectLightPos;
+	XMStoreFloat3(&objectLightPos, lightPosV);
+
+	// test oswietlenia scian na przygotowanych plaszczyznach i wyciaganie krawedzi sylwetki
+	bool flip = XMVectorGetX(det) < 0.f;
+	volume.skippedMeshlets = 0;
+	if (volume.temporalCoherence)
+		volume.tracker.Update(m_facePlanes, m_edgeFaces, m_faceEdges, objectLightPos, m_center, flip, volume.facing, volume.silhouette);
+	else if (!m_meshlets.empty())
+		volume.skippedMeshlets = GatherMeshletSilhouette(m_meshlets, m_facePlanes, m_edgeFaces, objectLightPos, flip,
+			volume.facing, volume.silhouette);
+	else
+	{
+		ClassifyFaces(m_facePlanes, objectLightPos, flip, volume.facing);
+		GatherSilhouetteEdges(m_edgeFaces, volume.facing, volume.silhouette);
+	}
+	const FaceBitset& facing = volume.facing;
+
+	// kazda pozycja daje co najwyzej dwa wierzcholki bryly: oryginalny (2p) i wyciagniety (2p + 1),
+	// dodawane przy pierwszym uzyciu
+	auto& slots = volume.vertexSlots;
+	slots.assign(2 * positions.size(), UINT32_MAX);
+	auto vertex = [&](unsigned p, bool extruded)
+	{
+		uint32_t& slot = slots[2 * p + extruded];
+		if (slot == UINT32_MAX) {
+			slot = static_cast<uint32_t>(volume.vertices.size());
+			XMVECTOR pos = XMVectorSetW(XMLoadFloat3(&positions[p]), 1.f);
+			if (extruded)
+				pos = extrude(pos, lightPosV, m, extrusionDistance);
+			volume.vertices.emplace_back();
+			XMStoreFloat4(&volume.vertices.back(), pos);
+		}
+		return slot;
+	};
+
+	for (uint32_t e : volume.silhouette) {
+		const Edge& edge = edges[e];
+		bool f0Front = facing[edge.face0];
+
+		unsigned backFaceIndex = f0Front ? edge.face1 : edge.face0;
+		const Face& backFace = faces[backFaceIndex];
+
+		unsigned ev0 = edge.v0;
+		unsigned ev1 = edge.v1;
+
+		if (!isEdgeOriented(ev0, ev1, backFace)) {
+			// dopasowanie windingu do windingu nieoswietlonej sciany
+			std::swap(ev0, ev1);
+		}
+
+		// sciana bryly: p0, p1, p1 wyciagniety, p0 wyciagniety
+		uint32_t quad[] = { vertex(ev0, false), vertex(ev1, false), vertex(ev1, true), vertex(ev0, true) };
+		volume.indices.insert(volume.indices.end(), { quad[0], quad[2], quad[1], quad[0], quad[3], quad[2] });
+	}
+
+	for (size_t i = 0; i < faces.size(); ++i) {
+		const Face& face = faces[i];
+		// gorny czepiec - oryginalne wierzcholki, dolny czepiec - wyciagane
+		bool extruded = !facing[i];
+		for (int j = 2; j >= 0; --j)
+			volume.indices.push_back(vertex(m_vertexPositions[face.indices[j]], extruded));
+	}
+
+	// do ukladu swiata przenoszona jest tylko wygenerowana geometria
+	if (space == VolumeSpace::World)
+		for (auto& v : volume.vertices)
+			XMStoreFloat4(&v, XMVector4Transform(XMLoadFloat4(&v), m));
+}
+
+void ShadowLodChain::Build(const ShadowCaster& caster, size_t minFaces)
+{
+	m_levels.clear();
+	m_errors.clear();
+	m_center = caster.Center();
+	XMVECTOR center = XMLoadFloat3(&m_center);
+	m_radius = 0.f;
+	for (const auto& p : caster.positions)
+		m_radius = max(m_radius, XMVectorGetX(XMVector3Length(XMLoadFloat3(&p) - center)));
+
+	// kazdy poziom upraszczany z poprzedniego; koniec, gdy uproszczenie juz nic nie daje
+	const ShadowCaster* previous = &caster;
+	while (previous->faces.size() / 2 > minFaces)
+	{
+		float error;
+		ShadowCaster level = previous->Simplified(previous->faces.size() / 2, &error);
+		if (level.faces.size() > previous->faces.size() * 3 / 4)
+			break;
+		// blad wzgledem pelnej siatki ograniczony suma bledow kolejnych uproszczen
+		m_errors.push_back(Error(m_levels.size()) + error);
+		m_levels.push_back(move(level));
+		previous = &m_levels.back();
+	}
+}
+
+size_t ShadowLodChain::Select(const LodView& view, const XMFLOAT4X4& worldMtx) const
+{
+	XMMATRIX m = XMLoadFloat4x4(&worldMtx);
+	XMVECTOR center = XMVector3Transform(XMLoadFloat3(&m_center), m);
+	// najwieksze skalowanie osi macierzy swiata
+	float scale = sqrtf(max({ XMVectorGetX(XMVector3LengthSq(m.r[0])), XMVectorGetX(XMVector3LengthSq(m.r[1])),
+		XMVectorGetX(XMVector3LengthSq(m.r[2])) }));
+	// odleglosc od najblizszego punktu kuli otaczajacej
+	float distance = XMVectorGetX(XMVector3Length(center - XMLoadFloat3(&view.eye))) - m_radius * scale;
+	if (distance <= 0.f)
+		return 0;
+	float pixelsPerUnit = view.projectionScale * scale / distance;
+	size_t level = 0;
+	while (level + 1 < Levels() && Error(level + 1) * pixelsPerUnit <= view.maxPixelError)
+		++level;
+	return level;
+}
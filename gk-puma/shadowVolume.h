@@ -0,0 +1,151 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include <limits>
+#include "silhouette.h"
+#include "meshAdjacency.h"
+#include "meshlets.h"
+#include "meshSimplify.h"
+
+//Platform-independent (CPU) half of the shadow volume generation.
+//Depends only on DirectXMath, so it can be built and tested without Direct3D.
+
+namespace mini
+{
+	//Coordinate system of the generated shadow volume geometry
+	enum class VolumeSpace
+	{
+		World,
+		//Same space as the caster; render with the caster's world matrix
+		Object
+	};
+
+	//Extrusion distance that sends extruded vertices to infinity: they are emitted
+	//as homogeneous points with w = 0, in the direction away from the light.
+	//Needs a projection matrix with an infinite far plane.
+	constexpr float InfiniteExtrusion = std::numeric_limits<float>::infinity();
+
+	//Indexed shadow volume triangle list. Every position of the caster contributes at most
+	//one original and one extruded vertex, shared by all quads and caps that use it.
+	//Vertices are homogeneous, w = 0 only for vertices extruded with InfiniteExtrusion.
+	struct ShadowVolume
+	{
+		std::vector<DirectX::XMFLOAT4> vertices;
+		std::vector<uint32_t> indices;
+		//Faces turned away from the light in the last generated frame
+		FaceBitset facing;
+		//Indices of silhouette edges in the last generated frame
+		std::vector<uint32_t> silhouette;
+		//Volume vertex of each original (2p) and extruded (2p + 1) position, scratch space
+		std::vector<uint32_t> vertexSlots;
+
+		//Update the silhouette incrementally from the previous frame (for animated casters)
+		bool temporalCoherence = false;
+		SilhouetteTracker tracker;
+		//Meshlets skipped by the last silhouette extraction (see ShadowCaster::BuildMeshlets)
+		size_t skippedMeshlets = 0;
+
+		void clear() { vertices.clear(); indices.clear(); }
+	};
+
+	//Geometry needed to build a shadow volume of a mesh.
+	//Edges index positions (unique vertex positions), faces index vertices
+	//(render vertices, possibly several per position because of normals).
+	class ShadowCaster
+	{
+	public:
+		std::vector<DirectX::XMFLOAT3> positions;
+		std::vector<DirectX::XMFLOAT3> vertices;
+		std::vector<Face> faces;
+		std::vector<Edge> edges;
+
+		//Precomputes face planes and edge adjacency for the silhouette kernels
+		//and the position of every vertex. Must be called after the geometry is set or changed,
+		//drops meshlets.
+		//Throws std::invalid_argument if a vertex does not lie at any of the positions
+		//or an edge has a single face (see CloseBoundaries).
+		void PrepareSilhouetteData();
+
+		//Replaces positions and edges with ones rebuilt from vertices and faces: welds vertices
+		//(see WeldPositions), builds edges and, if closeBoundaries, closes open parts of the mesh
+		//by adding faces. Calls PrepareSilhouetteData. Expected linear time.
+		AdjacencyStats BuildAdjacency(float weldTolerance = 0.f, bool closeBoundaries = true);
+
+		//Reorders faces and edges into meshlets (see mini::BuildMeshlets), used by GenerateShadowVolume
+		//without temporal coherence to skip meshlets entirely in front of or behind the light.
+		//Call after PrepareSilhouetteData or BuildAdjacency.
+		void BuildMeshlets(unsigned maxFaces = MeshletMaxFaces);
+		const std::vector<Meshlet>& Meshlets() const { return m_meshlets; }
+
+		//Prepares a caster of a drawn mesh, vertices and faces set: without edges the adjacency is
+		//rebuilt (BuildAdjacency), otherwise open boundaries are closed (CloseBoundaries) and
+		//PrepareSilhouetteData is called. Closed meshes, which needed no added faces, also get meshlets.
+		//Returns false if faces were added; if true, the faces were reordered and should be drawn in the new order.
+		bool PrepareMesh();
+
+		//Lower detail caster for shadows only: vertices are the positions, faces are simplified
+		//with SimplifyMesh to at most targetFaceCount faces, adjacency is rebuilt (still closed).
+		//error receives the simplification error in object space.
+		ShadowCaster Simplified(size_t targetFaceCount, float* error = nullptr) const;
+
+		//Center of the bounding box of the positions
+		DirectX::XMFLOAT3 Center() const { return m_center; }
+
+		//lightPos and extrusionDistance are given in world space (see InfiniteExtrusion). Silhouette tests run
+		//on the untransformed mesh, only the emitted geometry is transformed when
+		//space is VolumeSpace::World.
+		void GenerateShadowVolume(ShadowVolume& volume, DirectX::XMFLOAT3 lightPos,
+			const DirectX::XMFLOAT4X4& worldMtx, float extrusionDistance,
+			VolumeSpace space = VolumeSpace::World) const;
+
+	private:
+		FacePlanes m_facePlanes;
+		EdgeFaces m_edgeFaces;
+		FaceEdges m_faceEdges;
+		std::vector<Meshlet> m_meshlets;
+		DirectX::XMFLOAT3 m_center = {};
+		//Index of the position of each vertex
+		std::vector<unsigned> m_vertexPositions;
+
+		void prepare(std::vector<unsigned> vertexPositions);
+		bool isEdgeOriented(unsigned v0, unsigned v1, const Face& face) const;
+		static DirectX::XMVECTOR extrude(DirectX::FXMVECTOR pos, DirectX::FXMVECTOR lightPos,
+			DirectX::CXMMATRIX worldMtx, float extrusionDistance);
+	};
+
+	//Camera seen by shadow caster levels of detail
+	struct LodView
+	{
+		DirectX::XMFLOAT3 eye;
+		//Pixels per unit of length at distance 1: viewport height / (2 tan(fovY / 2))
+		float projectionScale;
+		//Largest tolerated simplification error on screen
+		float maxPixelError = 1.f;
+	};
+
+	//Simplified shadow casters of a mesh. Level 0 is the full caster (kept by the owner),
+	//level i > 0 has about 1 / 2^i of its faces.
+	class ShadowLodChain
+	{
+	public:
+		//Halves the face count while it stays above minFaces
+		void Build(const ShadowCaster& caster, size_t minFaces = 64);
+
+		//Number of levels including the full caster
+		size_t Levels() const { return m_levels.size() + 1; }
+		//Simplified caster of level > 0
+		const ShadowCaster& Level(size_t level) const { return m_levels[level - 1]; }
+		//Object-space error of a level, 0 for level 0
+		float Error(size_t level) const { return level ? m_errors[level - 1] : 0.f; }
+
+		//Coarsest level whose error projected from the mesh center, placed by worldMtx,
+		//stays within view.maxPixelError
+		size_t Select(const LodView& view, const DirectX::XMFLOAT4X4& worldMtx) const;
+
+	private:
+		std::vector<ShadowCaster> m_levels;
+		std::vector<float> m_errors;
+		DirectX::XMFLOAT3 m_center = {};
+		float m_radius = 0.f;
+	};
+}
@@ -0,0 +1,22 @@
+cbuffer cbWorld : register(b0) //Vertex Shader constant buffer slot 0
+{
+	matrix worldMatrix;
+};
+
+cbuffer cbView : register(b1) //Vertex Shader constant buffer slot 1
+{
+	matrix viewMatrix;
+	matrix invViewMatrix;
+};
+
+cbuffer cbProj : register(b2) //Vertex Shader constant buffer slot 2
+{
+	matrix projMatrix;
+};
+
+//Shadow volume vertices are homogeneous, extruded ones may lie at infinity (w = 0)
+float4 main(float4 pos : POSITION) : SV_POSITION
+{
+	float4 worldPos = mul(worldMatrix, pos);
+	return mul(projMatrix, mul(viewMatrix, worldPos));
+}
@@ -0,0 +1,360 @@
+#include "silhouette.h"
+#include "blockRange.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PUMA_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PUMA_TARGET(x) __attribute__((target(x)))
+#else
+#define PUMA_TARGET(x)
+#endif
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	bool TurnedAway(const FacePlanes& planes, size_t i, XMFLOAT3 l, float sign)
+	{
+		return (planes.d[i] - (planes.nx[i] * l.x + planes.ny[i] * l.y + planes.nz[i] * l.z)) * sign > 0.f;
+	}
+
+	void ClassifyFacesScalar(const FacePlanes& planes, XMFLOAT3 l, float sign, FaceBitset& facing, size_t first, size_t last)
+	{
+		uint32_t* words = facing.words();
+		for (size_t i = first; i < last; ++i)
+			words[i >> 5] |= static_cast<uint32_t>(TurnedAway(planes, i, l, sign)) << (i & 31);
+	}
+
+	void GatherSilhouetteEdgesScalar(const EdgeFaces& edges, const FaceBitset& facing, vector<uint32_t>& silhouette,
+		size_t first, size_t last)
+	{
+		const uint32_t* words = facing.words();
+		for (size_t i = first; i < last; ++i)
+		{
+			uint32_t f0 = edges.face0[i], f1 = edges.face1[i];
+			uint32_t b0 = words[f0 >> 5] >> (f0 & 31);
+			uint32_t b1 = words[f1 >> 5] >> (f1 & 31);
+			if ((b0 ^ b1) & 1u)
+				silhouette.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+#ifdef PUMA_X86
+	PUMA_TARGET("sse4.1")
+	void ClassifyFacesSSE4(const FacePlanes& planes, XMFLOAT3 l, float sign, FaceBitset& facing, size_t begin, size_t end)
+	{
+		// 4 faces per iteration, two iterations fill one byte of the bitset
+		auto bytes = reinterpret_cast<uint8_t*>(facing.words());
+		const __m128 lx = _mm_set1_ps(l.x), ly = _mm_set1_ps(l.y), lz = _mm_set1_ps(l.z);
+		const __m128 s = _mm_set1_ps(sign), zero = _mm_setzero_ps();
+		for (size_t i = begin; i < end; i += 8)
+		{
+			int mask = 0;
+			for (size_t j = 0; j < 8; j += 4)
+			{
+				__m128 dot = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_loadu_ps(&planes.nx[i + j]), lx),
+					_mm_mul_ps(_mm_loadu_ps(&planes.ny[i + j]), ly)),
+					_mm_mul_ps(_mm_loadu_ps(&planes.nz[i + j]), lz));
+				__m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&planes.d[i + j]), dot), s);
+				mask |= _mm_movemask_ps(_mm_cmpgt_ps(v, zero)) << j;
+			}
+			bytes[i >> 3] = static_cast<uint8_t>(mask);
+		}
+	}
+
+	PUMA_TARGET("avx2")
+	void ClassifyFacesAVX2(const FacePlanes& planes, XMFLOAT3 l, float sign, FaceBitset& facing, size_t begin, size_t end)
+	{
+		// 8 faces per iteration, one byte of the bitset
+		auto bytes = reinterpret_cast<uint8_t*>(facing.words());
+		const __m256 lx = _mm256_set1_ps(l.x), ly = _mm256_set1_ps(l.y), lz = _mm256_set1_ps(l.z);
+		const __m256 s = _mm256_set1_ps(sign), zero = _mm256_setzero_ps();
+		for (size_t i = begin; i < end; i += 8)
+		{
+			__m256 dot = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_loadu_ps(&planes.nx[i]), lx),
+				_mm256_mul_ps(_mm256_loadu_ps(&planes.ny[i]), ly)),
+				_mm256_mul_ps(_mm256_loadu_ps(&planes.nz[i]), lz));
+			__m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&planes.d[i]), dot), s);
+			bytes[i >> 3] = static_cast<uint8_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, zero, _CMP_GT_OQ)));
+		}
+	}
+
+	PUMA_TARGET("avx2,bmi")
+	void GatherSilhouetteEdgesAVX2(const EdgeFaces& edges, const FaceBitset& facing, vector<uint32_t>& silhouette,
+		size_t begin, size_t end)
+	{
+		const auto words = reinterpret_cast<const int*>(facing.words());
+		const __m256i bitMask = _mm256_set1_epi32(31), one = _mm256_set1_epi32(1);
+		for (size_t i = begin; i < end; i += 8)
+		{
+			__m256i f0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&edges.face0[i]));
+			__m256i f1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&edges.face1[i]));
+			__m256i w0 = _mm256_i32gather_epi32(words, _mm256_srli_epi32(f0, 5), 4);
+			__m256i w1 = _mm256_i32gather_epi32(words, _mm256_srli_epi32(f1, 5), 4);
+			__m256i b0 = _mm256_srlv_epi32(w0, _mm256_and_si256(f0, bitMask));
+			__m256i b1 = _mm256_srlv_epi32(w1, _mm256_and_si256(f1, bitMask));
+			__m256i x = _mm256_and_si256(_mm256_xor_si256(b0, b1), one);
+			auto mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(x, 31))));
+			// compact the set lanes into the output
+			for (; mask; mask &= mask - 1)
+				silhouette.push_back(static_cast<uint32_t>(i + _tzcnt_u32(mask)));
+		}
+	}
+#endif
+}
+
+void FaceBitset::set(size_t first, size_t count)
+{
+	// czesciowe slowa na brzegach, pelne slowa wypelniane
+	size_t last = first + count;
+	for (; first < last && (first & 31); ++first)
+		set(first);
+	for (; first + 32 <= last; first += 32)
+		m_words[first >> 5] = ~0u;
+	for (; first < last; ++first)
+		set(first);
+}
+
+size_t FaceBitset::count() const
+{
+	size_t result = 0;
+	for (auto word : m_words)
+		for (; word; word &= word - 1)
+			++result;
+	return result;
+}
+
+void FacePlanes::Build(const vector<XMFLOAT3>& vertices, const vector<Face>& faces)
+{
+	count = faces.size();
+	const size_t n = Padded<SilhouetteBlock>(count);
+	nx.assign(n, 0.f);
+	ny.assign(n, 0.f);
+	nz.assign(n, 0.f);
+	d.assign(n, 0.f);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Face& face = faces[i];
+		XMVECTOR p0 = XMLoadFloat3(&vertices[face.indices[0]]);
+		XMVECTOR p1 = XMLoadFloat3(&vertices[face.indices[1]]);
+		XMVECTOR p2 = XMLoadFloat3(&vertices[face.indices[2]]);
+		XMVECTOR normal = XMVector3Cross(p1 - p0, p2 - p0);
+		XMFLOAT3 nf;
+		XMStoreFloat3(&nf, normal);
+		nx[i] = nf.x;
+		ny[i] = nf.y;
+		nz[i] = nf.z;
+		d[i] = XMVectorGetX(XMVector3Dot(normal, p0));
+	}
+}
+
+void EdgeFaces::Build(const vector<Edge>& edges)
+{
+	count = edges.size();
+	const size_t n = Padded<SilhouetteBlock>(count);
+	face0.assign(n, 0u);
+	face1.assign(n, 0u);
+	for (size_t i = 0; i < count; ++i)
+	{
+		face0[i] = edges[i].face0;
+		face1[i] = edges[i].face1 == UINT_MAX ? edges[i].face0 : edges[i].face1;
+	}
+}
+
+void FaceEdges::Build(const vector<Edge>& edgeList, size_t faceCount)
+{
+	start.assign(faceCount + 1, 0u);
+	for (const Edge& e : edgeList)
+	{
+		++start[e.face0 + 1];
+		if (e.face1 != UINT_MAX)
+			++start[e.face1 + 1];
+	}
+	for (size_t f = 0; f < faceCount; ++f)
+		start[f + 1] += start[f];
+	edges.resize(start[faceCount]);
+	vector<uint32_t> next(start.begin(), start.end() - 1);
+	for (uint32_t i = 0; i < edgeList.size(); ++i)
+	{
+		edges[next[edgeList[i].face0]++] = i;
+		if (edgeList[i].face1 != UINT_MAX)
+			edges[next[edgeList[i].face1]++] = i;
+	}
+}
+
+SimdLevel mini::DetectSimdLevel()
+{
+	static const SimdLevel level = []
+	{
+#if defined(PUMA_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		bool sse41 = (info[2] & (1 << 19)) != 0;
+		bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		bool avx2 = false;
+		if (osAvx && maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0 && (info[1] & (1 << 3)) != 0;
+		}
+		return avx2 ? SimdLevel::AVX2 : sse41 ? SimdLevel::SSE4 : SimdLevel::Scalar;
+#elif defined(PUMA_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi"))
+			return SimdLevel::AVX2;
+		return __builtin_cpu_supports("sse4.1") ? SimdLevel::SSE4 : SimdLevel::Scalar;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}();
+	return level;
+}
+
+void mini::ClassifyFaces(const FacePlanes& planes, XMFLOAT3 lightPos, bool flip, FaceBitset& facing, SimdLevel level)
+{
+	facing.reset(planes.count);
+	ClassifyFaces(planes, lightPos, flip, 0, planes.count, facing, level);
+}
+
+void mini::ClassifyFaces(const FacePlanes& planes, XMFLOAT3 lightPos, bool flip, size_t first, size_t count,
+	FaceBitset& facing, SimdLevel level)
+{
+	const float sign = flip ? -1.f : 1.f;
+	auto scalar = [&](size_t b, size_t e) { ClassifyFacesScalar(planes, lightPos, sign, facing, b, e); };
+#ifdef PUMA_X86
+	if (level == SimdLevel::AVX2)
+		return SplitRange<SilhouetteBlock>(first, first + count, planes.count, scalar,
+			[&](size_t b, size_t e) { ClassifyFacesAVX2(planes, lightPos, sign, facing, b, e); });
+	if (level == SimdLevel::SSE4)
+		return SplitRange<SilhouetteBlock>(first, first + count, planes.count, scalar,
+			[&](size_t b, size_t e) { ClassifyFacesSSE4(planes, lightPos, sign, facing, b, e); });
+#endif
+	scalar(first, first + count);
+}
+
+void mini::GatherSilhouetteEdges(const EdgeFaces& edges, const FaceBitset& facing, vector<uint32_t>& silhouette, SimdLevel level)
+{
+	silhouette.clear();
+	GatherSilhouetteEdges(edges, facing, 0, edges.count, silhouette, level);
+}
+
+void mini::GatherSilhouetteEdges(const EdgeFaces& edges, const FaceBitset& facing, size_t first, size_t count,
+	vector<uint32_t>& silhouette, SimdLevel level)
+{
+	auto scalar = [&](size_t b, size_t e) { GatherSilhouetteEdgesScalar(edges, facing, silhouette, b, e); };
+#ifdef PUMA_X86
+	if (level == SimdLevel::AVX2)
+		return SplitRange<SilhouetteBlock>(first, first + count, edges.count, scalar,
+			[&](size_t b, size_t e) { GatherSilhouetteEdgesAVX2(edges, facing, silhouette, b, e); });
+#endif
+	scalar(first, first + count);
+}
+
+void SilhouetteTracker::fullScan(const FacePlanes& planes, const EdgeFaces& edges, XMFLOAT3 lightPos, XMFLOAT3 lightDir,
+	bool flip, FaceBitset& facing, vector<uint32_t>& silhouette)
+{
+	ClassifyFaces(planes, lightPos, flip, facing);
+	GatherSilhouetteEdges(edges, facing, silhouette);
+	m_inSilhouette.assign(edges.count, 0);
+	for (uint32_t e : silhouette)
+		m_inSilhouette[e] = 1;
+	m_faceStamp.assign(planes.count, 0u);
+	m_edgeStamp.assign(edges.count, 0u);
+	m_stamp = 0;
+	m_fullScan = true;
+	m_edgesTested = edges.count;
+	m_scanDir = lightDir;
+}
+
+void SilhouetteTracker::Update(const FacePlanes& planes, const EdgeFaces& edges, const FaceEdges& faceEdges,
+	XMFLOAT3 lightPos, XMFLOAT3 center, bool flip, FaceBitset& facing, vector<uint32_t>& silhouette)
+{
+	m_edgeCount = edges.count;
+	XMFLOAT3 lightDir;
+	XMStoreFloat3(&lightDir, XMVector3Normalize(XMLoadFloat3(&lightPos) - XMLoadFloat3(&center)));
+
+	// zmiana rozmiaru, odbicia lub zbyt duzy obrot swiatla od ostatniego pelnego przejscia
+	// (mierzony od niego, bo wolny obrot w wielu malych krokach tez gubi nowe petle sylwetki)
+	float cosAngle = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&lightDir), XMLoadFloat3(&m_scanDir)));
+	bool valid = m_valid && flip == m_flip && facing.size() == planes.count &&
+		m_inSilhouette.size() == edges.count && cosAngle >= cosf(rotationThreshold);
+	m_valid = true;
+	m_flip = flip;
+	if (!valid)
+		return fullScan(planes, edges, lightPos, lightDir, flip, facing, silhouette);
+
+	m_fullScan = false;
+	if (++m_stamp == 0)
+	{
+		// przepelnienie licznika
+		fill(m_faceStamp.begin(), m_faceStamp.end(), 0u);
+		fill(m_edgeStamp.begin(), m_edgeStamp.end(), 0u);
+		m_stamp = 1;
+	}
+	const float sign = flip ? -1.f : 1.f;
+	auto enqueue = [&](uint32_t f)
+	{
+		if (m_faceStamp[f] != m_stamp)
+		{
+			m_faceStamp[f] = m_stamp;
+			m_faceQueue.push_back(f);
+		}
+	};
+
+	// sciany przy starej sylwetce, dalej sasiedzi scian, ktore zmienily strone
+	m_faceQueue.clear();
+	m_testedEdges.clear();
+	for (uint32_t e : silhouette)
+	{
+		enqueue(edges.face0[e]);
+		enqueue(edges.face1[e]);
+	}
+	for (size_t q = 0; q < m_faceQueue.size(); ++q)
+	{
+		uint32_t f = m_faceQueue[q];
+		bool away = TurnedAway(planes, f, lightPos, sign);
+		bool changed = away != facing[f];
+		if (changed)
+			facing.words()[f >> 5] ^= 1u << (f & 31);
+		for (uint32_t i = faceEdges.start[f]; i < faceEdges.start[f + 1]; ++i)
+		{
+			uint32_t e = faceEdges.edges[i];
+			if (m_edgeStamp[e] != m_stamp)
+			{
+				m_edgeStamp[e] = m_stamp;
+				m_testedEdges.push_back(e);
+			}
+			if (changed)
+				enqueue(edges.face0[e] == f ? edges.face1[e] : edges.face0[e]);
+		}
+	}
+
+	// stare krawedzie, ktore zostaly w sylwetce, i nowe
+	auto kept = remove_if(silhouette.begin(), silhouette.end(), [&](uint32_t e)
+	{
+		return facing[edges.face0[e]] == facing[edges.face1[e]];
+	});
+	silhouette.erase(kept, silhouette.end());
+	for (uint32_t e : m_testedEdges)
+	{
+		uint8_t in = facing[edges.face0[e]] != facing[edges.face1[e]];
+		if (in && !m_inSilhouette[e])
+			silhouette.push_back(e);
+		m_inSilhouette[e] = in;
+	}
+	m_edgesTested = m_testedEdges.size();
+}
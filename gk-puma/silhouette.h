@@ -0,0 +1,153 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+#include <climits>
+
+//Mesh topology used by shadow volumes and the vectorized silhouette kernels.
+//Kernels work on structure-of-arrays data padded to SilhouetteBlock elements
+//and pick SSE4/AVX2 code paths at run time, with a scalar fallback.
+
+namespace mini
+{
+	struct Edge {
+		unsigned v0, v1;
+		unsigned face0, face1;
+
+		Edge() {}
+
+		Edge(unsigned v0, unsigned v1, unsigned face0, unsigned face1)
+			: v0(v0), v1(v1), face0(face0), face1(face1)
+		{
+		}
+	};
+
+	struct Face
+	{
+		unsigned indices[3];
+		Face() {}
+		Face(unsigned v0, unsigned v1, unsigned v2)
+		{
+			indices[0] = v0;
+			indices[1] = v1;
+			indices[2] = v2;
+		}
+	};
+
+	//Compact per-face flags, one bit per face
+	class FaceBitset
+	{
+	public:
+		void reset(size_t count) { m_words.assign((count + 31) / 32, 0u); m_count = count; }
+		void set(size_t i) { m_words[i >> 5] |= 1u << (i & 31); }
+		//Sets bits first .. first + count - 1
+		void set(size_t first, size_t count);
+		bool operator[](size_t i) const { return (m_words[i >> 5] >> (i & 31)) & 1u; }
+		size_t size() const { return m_count; }
+		size_t count() const;
+
+		uint32_t* words() { return m_words.data(); }
+		const uint32_t* words() const { return m_words.data(); }
+
+	private:
+		std::vector<uint32_t> m_words;
+		size_t m_count = 0;
+	};
+
+	//Number of faces/edges processed by one AVX2 iteration; SoA arrays are padded to it
+	constexpr size_t SilhouetteBlock = 8;
+
+	//Face planes n.x + d = 0 (n not normalized), n = (p1 - p0) x (p2 - p0).
+	//Padding planes are all zeros and never classify as facing away.
+	struct FacePlanes
+	{
+		std::vector<float> nx, ny, nz, d;
+		size_t count = 0;
+
+		void Build(const std::vector<DirectX::XMFLOAT3>& vertices, const std::vector<Face>& faces);
+	};
+
+	//Faces adjacent to each edge. Open edges reference face0 twice,
+	//so they are never part of the silhouette.
+	struct EdgeFaces
+	{
+		std::vector<uint32_t> face0, face1;
+		size_t count = 0;
+
+		void Build(const std::vector<Edge>& edges);
+	};
+
+	//Edges of every face in compressed rows: edges[start[f]] .. edges[start[f + 1] - 1]
+	struct FaceEdges
+	{
+		std::vector<uint32_t> start, edges;
+
+		void Build(const std::vector<Edge>& edges, size_t faceCount);
+	};
+
+	enum class SimdLevel { Scalar, SSE4, AVX2 };
+
+	//Best level supported by the CPU (and operating system, for AVX)
+	SimdLevel DetectSimdLevel();
+
+	//Sets a bit for every face turned away from lightPos (given in the planes' space).
+	//flip inverts the test, needed when the planes were transformed by a mirroring matrix.
+	void ClassifyFaces(const FacePlanes& planes, DirectX::XMFLOAT3 lightPos, bool flip,
+		FaceBitset& facing, SimdLevel level = DetectSimdLevel());
+	//Classifies only faces first .. first + count - 1. facing must already be reset
+	//to planes.count faces, with bits of the range cleared.
+	void ClassifyFaces(const FacePlanes& planes, DirectX::XMFLOAT3 lightPos, bool flip, size_t first, size_t count,
+		FaceBitset& facing, SimdLevel level = DetectSimdLevel());
+
+	//Writes indices of edges whose adjacent faces differ in facing
+	void GatherSilhouetteEdges(const EdgeFaces& edges, const FaceBitset& facing,
+		std::vector<uint32_t>& silhouette, SimdLevel level = DetectSimdLevel());
+	//Appends silhouette edges among edges first .. first + count - 1, in increasing order
+	void GatherSilhouetteEdges(const EdgeFaces& edges, const FaceBitset& facing, size_t first, size_t count,
+		std::vector<uint32_t>& silhouette, SimdLevel level = DetectSimdLevel());
+
+	//Keeps the silhouette of a moving caster between frames. Only faces next to the last
+	//silhouette are re-tested, spreading to neighbours of faces that changed facing.
+	//Changes not connected to the last silhouette are missed, so a full scan is done
+	//when the light direction seen from the caster has rotated more than rotationThreshold
+	//since the last full scan, also when it gets there in many small steps.
+	class SilhouetteTracker
+	{
+	public:
+		//Radians since the last full scan
+		float rotationThreshold = 0.1f;
+
+		//Forces a full scan on the next update
+		void Reset() { m_valid = false; }
+
+		//Same results as ClassifyFaces + GatherSilhouetteEdges, except for the order of edges.
+		//facing and silhouette must hold the results of the previous update.
+		//center is the point the light direction is measured from (e.g. the caster's center).
+		void Update(const FacePlanes& planes, const EdgeFaces& edges, const FaceEdges& faceEdges,
+			DirectX::XMFLOAT3 lightPos, DirectX::XMFLOAT3 center, bool flip,
+			FaceBitset& facing, std::vector<uint32_t>& silhouette);
+
+		bool FullScan() const { return m_fullScan; }
+		size_t EdgesTested() const { return m_edgesTested; }
+		//Fraction of all edges tested in the last update
+		float TestedFraction() const { return m_edgeCount ? static_cast<float>(m_edgesTested) / m_edgeCount : 0.f; }
+
+	private:
+		bool m_valid = false;
+		bool m_flip = false;
+		bool m_fullScan = false;
+		//Light direction of the last full scan
+		DirectX::XMFLOAT3 m_scanDir = {};
+		size_t m_edgesTested = 0;
+		size_t m_edgeCount = 0;
+
+		std::vector<uint8_t> m_inSilhouette;
+		//Frame stamps of tested faces and edges, avoid clearing per update
+		std::vector<uint32_t> m_faceStamp, m_edgeStamp;
+		uint32_t m_stamp = 0;
+		std::vector<uint32_t> m_faceQueue, m_testedEdges;
+
+		void fullScan(const FacePlanes& planes, const EdgeFaces& edges, DirectX::XMFLOAT3 lightPos, DirectX::XMFLOAT3 lightDir,
+			bool flip, FaceBitset& facing, std::vector<uint32_t>& silhouette);
+	};
+}
@@ -0,0 +1,81 @@
+#include "textParser.h"
+#include <charconv>
+
+using namespace mini;
+using namespace std;
+
+TextParseError::TextParseError(string_view source, size_t line, size_t column, const string& message)
+	: runtime_error(string(source) + ":" + to_string(line) + ":" + to_string(column) + ": " + message),
+	m_line(line), m_column(column)
+{
+}
+
+TextParser::TextParser(const char* begin, const char* end, string_view source)
+	: m_pos(begin), m_end(end), m_lineStart(begin), m_source(source)
+{
+}
+
+namespace
+{
+	template<typename T>
+	const char* Parse(const char* begin, const char* end, T& value)
+	{
+		auto [next, error] = from_chars(begin, end, value);
+		return error == errc() ? next : nullptr;
+	}
+}
+
+unsigned TextParser::readUnsigned()
+{
+	if (m_pos == m_end)
+		fail("unexpected end of file, expected unsigned integer");
+	unsigned value;
+	const char* next = Parse(m_pos, m_end, value);
+	// token musi konczyc sie bialym znakiem, "1.5" nie jest liczba calkowita
+	if (!next || (next != m_end && !isSpace(*next)))
+		fail("expected unsigned integer");
+	m_pos = next;
+	return value;
+}
+
+float TextParser::readFloat()
+{
+	if (m_pos == m_end)
+		fail("unexpected end of file, expected number");
+	float value;
+	const char* next = Parse(m_pos, m_end, value);
+	if (!next || (next != m_end && !isSpace(*next)))
+		fail("expected number");
+	m_pos = next;
+	return value;
+}
+
+size_t TextParser::ReadCount(size_t minTokens)
+{
+	const char* start = m_pos;
+	size_t line = m_line;
+	const char* lineStart = m_lineStart;
+	size_t count = ReadUnsigned();
+	// kazdy token zajmuje co najmniej dwa znaki (z separatorem)
+	if (minTokens && count > static_cast<size_t>(m_end - m_pos) / (2 * minTokens))
+	{
+		m_pos = start;
+		m_line = line;
+		m_lineStart = lineStart;
+		skipWhitespace();
+		fail("count " + to_string(count) + " exceeds the file size");
+	}
+	return count;
+}
+
+void TextParser::ExpectEnd()
+{
+	skipWhitespace();
+	if (m_pos != m_end)
+		fail("unexpected data after the end of the mesh");
+}
+
+void TextParser::fail(const string& message) const
+{
+	throw TextParseError(m_source, Line(), Column(), message);
+}
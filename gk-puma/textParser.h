@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+//Whitespace-separated number tokenizer over a text buffer (e.g. a mapped file).
+//Numbers are read with std::from_chars: no allocations, no locale.
+
+namespace mini
+{
+	//Error with the 1-based position of the offending token
+	class TextParseError : public std::runtime_error
+	{
+	public:
+		TextParseError(std::string_view source, size_t line, size_t column, const std::string& message);
+
+		size_t line() const { return m_line; }
+		size_t column() const { return m_column; }
+
+	private:
+		size_t m_line, m_column;
+	};
+
+	class TextParser
+	{
+	public:
+		//source names the buffer in error messages and must outlive the parser
+		TextParser(const char* begin, const char* end, std::string_view source = {});
+
+		//Fast paths are inline, longer or malformed tokens go through std::from_chars
+		unsigned ReadUnsigned();
+		float ReadFloat();
+		//Element count followed by at least count * minTokens tokens; rejects counts
+		//that cannot fit in the rest of the buffer before anything is allocated
+		size_t ReadCount(size_t minTokens);
+		//Only whitespace may remain
+		void ExpectEnd();
+
+		size_t Line() const { return m_line; }
+		size_t Column() const { return static_cast<size_t>(m_pos - m_lineStart) + 1; }
+
+	private:
+		static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+		static bool isDigit(char c) { return static_cast<unsigned>(c - '0') < 10; }
+		void skipWhitespace();
+		unsigned readUnsigned();
+		float readFloat();
+		[[noreturn]] void fail(const std::string& message) const;
+
+		const char* m_pos;
+		const char* m_end;
+		const char* m_lineStart;
+		size_t m_line = 1;
+		std::string_view m_source;
+	};
+
+	inline void TextParser::skipWhitespace()
+	{
+		for (; m_pos != m_end && isSpace(*m_pos); ++m_pos)
+			if (*m_pos == '\n')
+			{
+				++m_line;
+				m_lineStart = m_pos + 1;
+			}
+	}
+
+	inline unsigned TextParser::ReadUnsigned()
+	{
+		// do 9 cyfr bez przepelnienia
+		skipWhitespace();
+		const char* p = m_pos;
+		unsigned value = 0;
+		int digits = 0;
+		for (; p != m_end && isDigit(*p) && digits < 10; ++p, ++digits)
+			value = 10 * value + (*p - '0');
+		if (digits == 0 || digits > 9 || (p != m_end && !isSpace(*p)))
+			return readUnsigned();
+		m_pos = p;
+		return value;
+	}
+
+	inline float TextParser::ReadFloat()
+	{
+		// [-]cyfry[.cyfry] z co najwyzej 7 cyframi: mantysa i potega 10 sa dokladne we float,
+		// wiec jedno dzielenie daje ten sam (poprawnie zaokraglony) wynik co from_chars
+		static constexpr float powers[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f };
+		skipWhitespace();
+		const char* p = m_pos;
+		bool negative = p != m_end && *p == '-';
+		p += negative;
+		unsigned mantissa = 0;
+		int digits = 0, fraction = 0;
+		for (; p != m_end && isDigit(*p) && digits < 8; ++p, ++digits)
+			mantissa = 10 * mantissa + (*p - '0');
+		if (p != m_end && *p == '.')
+			for (++p; p != m_end && isDigit(*p) && digits < 8; ++p, ++digits, ++fraction)
+				mantissa = 10 * mantissa + (*p - '0');
+		if (digits == 0 || digits > 7 || (p != m_end && !isSpace(*p)))
+			return readFloat();
+		m_pos = p;
+		float value = static_cast<float>(mantissa) / powers[fraction];
+		return negative ? -value : value;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <DirectXMath.h>
+
+//Polynomial approximations of inverse trigonometric functions on all lanes of a vector,
+//without branches, for the batch kernels. sin and cos come from XMVectorSinCos.
+
+namespace mini
+{
+	//Largest absolute error of VectorATan2 and VectorACos in radians (checked by the tests)
+	constexpr float VectorTrigMaxError = 5e-6f;
+
+	//atan2(y, x) in [-pi, pi], 0 for (0, 0)
+	inline DirectX::XMVECTOR XM_CALLCONV VectorATan2(DirectX::FXMVECTOR y, DirectX::FXMVECTOR x)
+	{
+		using namespace DirectX;
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR ax = XMVectorAbs(x), ay = XMVectorAbs(y);
+		const XMVECTOR hi = XMVectorMax(ax, ay), lo = XMVectorMin(ax, ay);
+		// t = lo / hi w [0, 1], wielomian nieparzysty stopnia 11 (minimax atan na [-1, 1])
+		const XMVECTOR t = XMVectorSelect(lo / hi, zero, XMVectorEqual(hi, zero));
+		const XMVECTOR t2 = t * t;
+		XMVECTOR r = XMVectorMultiplyAdd(t2, XMVectorReplicate(-0.01172120f), XMVectorReplicate(0.05265332f));
+		r = XMVectorMultiplyAdd(t2, r, XMVectorReplicate(-0.11643287f));
+		r = XMVectorMultiplyAdd(t2, r, XMVectorReplicate(0.19354346f));
+		r = XMVectorMultiplyAdd(t2, r, XMVectorReplicate(-0.33262347f));
+		r = XMVectorMultiplyAdd(t2, r, XMVectorReplicate(0.99997726f));
+		r = r * t;
+		// powrot do pelnego zakresu: zamiana osi, lewa polplaszczyzna, znak y
+		r = XMVectorSelect(r, XMVectorReplicate(XM_PIDIV2) - r, XMVectorGreater(ay, ax));
+		r = XMVectorSelect(r, XMVectorReplicate(XM_PI) - r, XMVectorLess(x, zero));
+		return XMVectorSelect(r, -r, XMVectorLess(y, zero));
+	}
+
+	//acos(x) in [0, pi], x is clamped to [-1, 1]
+	inline DirectX::XMVECTOR XM_CALLCONV VectorACos(DirectX::FXMVECTOR x)
+	{
+		using namespace DirectX;
+		const XMVECTOR one = XMVectorSplatOne();
+		const XMVECTOR c = XMVectorClamp(x, -one, one);
+		// (1 - x)(1 + x) zamiast 1 - x^2: dokladniej przy |x| bliskim 1
+		return VectorATan2(XMVectorSqrt((one - c) * (one + c)), c);
+	}
+}
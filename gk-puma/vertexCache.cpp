@@ -0,0 +1,191 @@
+#include "vertexCache.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mini;
+using namespace std;
+
+namespace
+{
+	constexpr uint32_t None = UINT32_MAX;
+
+	//Vertex scores of Forsyth's optimizer, tabulated by cache position and live triangle count
+	class VertexScores
+	{
+	public:
+		static constexpr unsigned MaxValence = 32;
+
+		VertexScores()
+		{
+			// wierzcholki ostatniego trojkata - stala ocena (kolejnosc ich uzycia bez znaczenia),
+			// dalsze maleja z pozycja w pamieci podrecznej
+			const float cacheDecayPower = 1.5f, lastTriangleScore = 0.75f;
+			const float valenceBoostScale = 2.0f, valenceBoostPower = 0.5f;
+			for (unsigned i = 0; i < VertexCacheSize; ++i)
+				m_cache[i] = i < 3 ? lastTriangleScore
+					: powf(1.0f - float(i - 3) / (VertexCacheSize - 3), cacheDecayPower);
+			// premia dla wierzcholkow z malo pozostalymi trojkatami - nie zostaja samotne trojkaty
+			m_valence[0] = 0.0f;
+			for (unsigned i = 1; i <= MaxValence; ++i)
+				m_valence[i] = valenceBoostScale * powf(float(i), -valenceBoostPower);
+		}
+
+		float operator()(uint32_t cachePosition, uint32_t liveTriangles) const
+		{
+			if (liveTriangles == 0)
+				return -1.0f;
+			float score = cachePosition < VertexCacheSize ? m_cache[cachePosition] : 0.0f;
+			return score + m_valence[min(liveTriangles, MaxValence)];
+		}
+
+	private:
+		float m_cache[VertexCacheSize];
+		float m_valence[MaxValence + 1];
+	};
+}
+
+float mini::SimulateAcmr(const vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+	// wierzcholek jest w kolejce FIFO, jesli od jego wstawienia bylo mniej niz cacheSize chybien
+	vector<size_t> inserted(vertexCount, 0);
+	size_t misses = 0;
+	for (uint32_t index : indices)
+		if (inserted[index] == 0 || misses - inserted[index] >= cacheSize)
+			inserted[index] = ++misses;
+	return float(misses) / float(indices.size() / 3);
+}
+
+vector<uint32_t> mini::OptimizeVertexCache(vector<uint32_t>& indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+	const VertexScores vertexScore;
+
+	// trojkaty kazdego wierzcholka (CSR); nieodwiedzone trojkaty na poczatku listy, liveCount ich liczba
+	vector<uint32_t> liveCount(vertexCount, 0), offsets(vertexCount + 1, 0), triangles(3 * triangleCount);
+	for (size_t i = 0; i < 3 * triangleCount; ++i)
+		++liveCount[indices[i]];
+	for (size_t v = 0; v < vertexCount; ++v)
+		offsets[v + 1] = offsets[v] + liveCount[v];
+	{
+		vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < 3 * triangleCount; ++i)
+			triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	vector<uint32_t> cachePosition(vertexCount, None);
+	vector<float> score(vertexCount), triangleScore(triangleCount, 0.0f);
+	for (size_t v = 0; v < vertexCount; ++v)
+		score[v] = vertexScore(None, liveCount[v]);
+	uint32_t best = None;
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		for (int i = 0; i < 3; ++i)
+			triangleScore[t] += score[indices[3 * t + i]];
+		if (best == None || triangleScore[t] > triangleScore[best])
+			best = static_cast<uint32_t>(t);
+	}
+
+	vector<uint8_t> emitted(triangleCount, 0);
+	vector<uint32_t> order, cache, newCache;
+	order.reserve(triangleCount);
+	cache.reserve(VertexCacheSize + 3);
+	newCache.reserve(VertexCacheSize + 3);
+	size_t next = 0;
+	while (order.size() < triangleCount)
+	{
+		// zaden trojkat wierzcholkow z pamieci podrecznej - pierwszy nieodwiedzony w kolejnosci wejsciowej
+		if (best == None)
+		{
+			while (emitted[next])
+				++next;
+			best = static_cast<uint32_t>(next);
+		}
+		emitted[best] = 1;
+		order.push_back(best);
+
+		newCache.clear();
+		for (int i = 0; i < 3; ++i)
+		{
+			uint32_t v = indices[3 * best + i];
+			uint32_t* live = triangles.data() + offsets[v];
+			uint32_t* it = find(live, live + liveCount[v], best);
+			swap(*it, live[--liveCount[v]]);
+			if (find(newCache.begin(), newCache.end(), v) == newCache.end())
+				newCache.push_back(v);
+		}
+		for (uint32_t v : cache)
+			if (find(newCache.begin(), newCache.end(), v) == newCache.end())
+				newCache.push_back(v);
+
+		// nowe oceny wierzcholkow zmieniaja oceny ich trojkatow; wypchniete z pamieci tez
+		for (size_t i = 0; i < newCache.size(); ++i)
+		{
+			uint32_t v = newCache[i];
+			cachePosition[v] = i < VertexCacheSize ? static_cast<uint32_t>(i) : None;
+			float s = vertexScore(cachePosition[v], liveCount[v]);
+			float delta = s - score[v];
+			score[v] = s;
+			for (uint32_t j = 0; j < liveCount[v]; ++j)
+				triangleScore[triangles[offsets[v] + j]] += delta;
+		}
+		best = None;
+		newCache.resize(min<size_t>(newCache.size(), VertexCacheSize));
+		for (uint32_t v : newCache)
+			for (uint32_t j = 0; j < liveCount[v]; ++j)
+			{
+				uint32_t t = triangles[offsets[v] + j];
+				if (best == None || triangleScore[t] > triangleScore[best])
+					best = t;
+			}
+		cache.swap(newCache);
+	}
+
+	vector<uint32_t> reordered(3 * triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t)
+		copy_n(indices.begin() + 3 * order[t], 3, reordered.begin() + 3 * t);
+	copy(reordered.begin(), reordered.end(), indices.begin());
+	return order;
+}
+
+vector<uint32_t> mini::OptimizeVertexFetch(vector<uint32_t>& indices, size_t vertexCount)
+{
+	vector<uint32_t> remap(vertexCount, None);
+	uint32_t next = 0;
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == None)
+			remap[index] = next++;
+		index = remap[index];
+	}
+	for (uint32_t& r : remap)
+		if (r == None)
+			r = next++;
+	return remap;
+}
+
+void mini::OptimizeVertexOrder(MeshData& mesh)
+{
+	vector<uint32_t> indices;
+	indices.reserve(3 * mesh.faces.size());
+	for (const Face& face : mesh.faces)
+		indices.insert(indices.end(), begin(face.indices), end(face.indices));
+	vector<uint32_t> order = OptimizeVertexCache(indices, mesh.vertexPositions.size());
+	vector<uint32_t> remap = OptimizeVertexFetch(indices, mesh.vertexPositions.size());
+	RemapVertices(mesh.vertexPositions, remap);
+	RemapVertices(mesh.normals, remap);
+
+	vector<uint32_t> newFace(order.size());
+	for (uint32_t i = 0; i < order.size(); ++i)
+	{
+		newFace[order[i]] = i;
+		mesh.faces[i] = Face(indices[3 * i], indices[3 * i + 1], indices[3 * i + 2]);
+	}
+	for (Edge& edge : mesh.edges)
+	{
+		edge.face0 = newFace[edge.face0];
+		if (edge.face1 != UINT_MAX)
+			edge.face1 = newFace[edge.face1];
+	}
+}
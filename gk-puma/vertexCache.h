@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "meshFile.h"
+
+//Load-time reordering of indexed triangle lists for the GPU vertex caches:
+//triangles for the post-transform cache, vertices for fetch locality.
+
+namespace mini
+{
+	//Cache size assumed by the optimizer and used by default by the simulator
+	constexpr unsigned VertexCacheSize = 32;
+
+	//Average cache miss ratio: vertices transformed per triangle with a FIFO post-transform
+	//cache of cacheSize entries. 3 means no reuse, about 0.5 is the limit for large grids.
+	float SimulateAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize = VertexCacheSize);
+
+	//Reorders triangles of a triangle list for the post-transform cache with Forsyth's
+	//linear-speed optimizer. Returns the old index of each triangle in the new order.
+	std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	//Renumbers vertices in order of first use by indices (unused vertices go last)
+	//and rewrites indices. Returns the new index of each vertex, see RemapVertices.
+	std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	template<typename T>
+	void RemapVertices(std::vector<T>& vertices, const std::vector<uint32_t>& remap)
+	{
+		std::vector<T> result(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+			result[remap[i]] = vertices[i];
+		vertices.swap(result);
+	}
+
+	//Both passes above applied to faces and vertices of a mesh; edges are updated
+	//to the new face order, positions stay in place
+	void OptimizeVertexOrder(MeshData& mesh);
+}
@@ -0,0 +1,27 @@
+// Decoding of quantized vertices (QuantizedVertex, vertexQuantization.h).
+// Float vertices are bound with positionOffset = 0, positionScale = (1, 1, 1, 0).
+
+cbuffer cbVertexDecode : register(b4) //Vertex Shader constant buffer slot 4
+{
+	float4 positionOffset;
+	float4 positionScale; // w != 0 - octahedral normals
+};
+
+float3 DecodeOctahedral(float2 e)
+{
+	float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += n.xy >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+float3 DecodePosition(float3 pos)
+{
+	return positionOffset.xyz + pos * positionScale.xyz;
+}
+
+// Quantized normals arrive as R16G16_SNORM (z = 0)
+float3 DecodeNormal(float3 norm)
+{
+	return positionScale.w != 0.0f ? DecodeOctahedral(norm.xy) : norm;
+}
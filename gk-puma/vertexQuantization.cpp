@@ -0,0 +1,125 @@
+#include "vertexQuantization.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace mini;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	constexpr float UnormMax = 65535.f;
+	constexpr float SnormMax = 32767.f;
+
+	//Octahedral coordinates in [-1, 1] of a direction
+	XMFLOAT2 ToOctahedral(XMFLOAT3 n)
+	{
+		float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+		if (l1 == 0.f)
+			return { 0.f, 0.f };
+		float x = n.x / l1, y = n.y / l1;
+		// dolna polowa osmioscianu odbita na rogi kwadratu
+		if (n.z < 0.f)
+		{
+			float ox = (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f);
+			float oy = (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f);
+			x = ox;
+			y = oy;
+		}
+		return { x, y };
+	}
+
+	float SnormToFloat(int16_t v)
+	{
+		return max(v / SnormMax, -1.f);
+	}
+}
+
+VertexDecode mini::QuantizationBox(const vector<XMFLOAT3>& positions)
+{
+	VertexDecode decode;
+	XMVECTOR minP = XMVectorReplicate(FLT_MAX), maxP = XMVectorReplicate(-FLT_MAX);
+	for (const auto& p : positions)
+	{
+		minP = XMVectorMin(minP, XMLoadFloat3(&p));
+		maxP = XMVectorMax(maxP, XMLoadFloat3(&p));
+	}
+	if (positions.empty())
+		minP = maxP = XMVectorZero();
+	XMStoreFloat4(&decode.positionOffset, XMVectorSetW(minP, 0.f));
+	XMStoreFloat4(&decode.positionScale, XMVectorSetW(maxP - minP, 1.f));
+	return decode;
+}
+
+float mini::MaxPositionError(const VertexDecode& decode)
+{
+	const XMFLOAT4& s = decode.positionScale;
+	// pol kroku kwantyzacji i blad zaokraglenia float przy dekodowaniu
+	float step = max({ s.x, s.y, s.z }) / UnormMax;
+	const XMFLOAT4& o = decode.positionOffset;
+	float magnitude = max({ fabsf(o.x), fabsf(o.y), fabsf(o.z) }) + max({ s.x, s.y, s.z });
+	return 0.5f * step + 4.f * FLT_EPSILON * magnitude;
+}
+
+void mini::EncodeOctahedral(const XMFLOAT3& normal, int16_t encoded[2])
+{
+	XMFLOAT2 o = ToOctahedral(normal);
+	XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&normal));
+	if (XMVector3Equal(XMLoadFloat3(&normal), XMVectorZero()))
+		n = XMVectorSet(0.f, 0.f, 1.f, 0.f);
+	// z czterech sasiednich wartosci calkowitych wybierana najblizsza po zdekodowaniu;
+	// odleglosc, bo iloczyn skalarny we float nie rozroznia katow rzedu 1e-5
+	float fx = floorf(o.x * SnormMax), fy = floorf(o.y * SnormMax);
+	float bestDistance = FLT_MAX;
+	for (int dx = 0; dx <= 1; ++dx)
+		for (int dy = 0; dy <= 1; ++dy)
+		{
+			int16_t candidate[2] = { static_cast<int16_t>(clamp(fx + dx, -SnormMax, SnormMax)),
+				static_cast<int16_t>(clamp(fy + dy, -SnormMax, SnormMax)) };
+			XMFLOAT3 decoded = DecodeOctahedral(candidate);
+			float distance = XMVectorGetX(XMVector3LengthSq(n - XMLoadFloat3(&decoded)));
+			if (distance < bestDistance)
+			{
+				bestDistance = distance;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+}
+
+XMFLOAT3 mini::DecodeOctahedral(const int16_t encoded[2])
+{
+	float x = SnormToFloat(encoded[0]), y = SnormToFloat(encoded[1]);
+	float z = 1.f - fabsf(x) - fabsf(y);
+	float t = max(-z, 0.f);
+	x += x >= 0.f ? -t : t;
+	y += y >= 0.f ? -t : t;
+	XMFLOAT3 n;
+	XMStoreFloat3(&n, XMVector3Normalize(XMVectorSet(x, y, z, 0.f)));
+	return n;
+}
+
+QuantizedVertex mini::EncodeVertex(const XMFLOAT3& position, const XMFLOAT3& normal, const VertexDecode& decode)
+{
+	QuantizedVertex v = {};
+	const float p[3] = { position.x, position.y, position.z };
+	const float offset[3] = { decode.positionOffset.x, decode.positionOffset.y, decode.positionOffset.z };
+	const float scale[3] = { decode.positionScale.x, decode.positionScale.y, decode.positionScale.z };
+	for (int i = 0; i < 3; ++i)
+	{
+		float t = scale[i] > 0.f ? clamp((p[i] - offset[i]) / scale[i], 0.f, 1.f) : 0.f;
+		v.position[i] = static_cast<uint16_t>(lrintf(t * UnormMax));
+	}
+	EncodeOctahedral(normal, v.normal);
+	return v;
+}
+
+void mini::DecodeVertex(const QuantizedVertex& vertex, const VertexDecode& decode, XMFLOAT3& position, XMFLOAT3& normal)
+{
+	const XMFLOAT4& o = decode.positionOffset;
+	const XMFLOAT4& s = decode.positionScale;
+	position = { o.x + vertex.position[0] / UnormMax * s.x, o.y + vertex.position[1] / UnormMax * s.y,
+		o.z + vertex.position[2] / UnormMax * s.z };
+	normal = DecodeOctahedral(vertex.normal);
+}
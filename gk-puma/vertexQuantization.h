@@ -0,0 +1,48 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+//Compact vertices for meshes with positions and normals: positions as 16-bit unsigned
+//normalized coordinates inside the mesh bounding box, normals octahedral-encoded in two
+//16-bit signed normalized values. 12 bytes instead of the 24 of VertexPositionNormal.
+
+namespace mini
+{
+	struct QuantizedVertex
+	{
+		//x, y, z in the box; w unused (there is no 3 x 16-bit vertex format)
+		uint16_t position[4];
+		int16_t normal[2];
+	};
+	static_assert(sizeof(QuantizedVertex) == 12, "QuantizedVertex must match its input layout");
+
+	//Decoding constants of a mesh, uploaded to the vertex shader (cbVertexDecode in phongVS):
+	//position = positionOffset + unorm * positionScale, octahedral normals if positionScale.w != 0.
+	//The defaults leave float vertices unchanged.
+	struct VertexDecode
+	{
+		DirectX::XMFLOAT4 positionOffset = { 0.f, 0.f, 0.f, 0.f };
+		DirectX::XMFLOAT4 positionScale = { 1.f, 1.f, 1.f, 0.f };
+
+		bool Quantized() const { return positionScale.w != 0.f; }
+	};
+
+	//Decoding of vertices quantized inside the bounding box of positions
+	VertexDecode QuantizationBox(const std::vector<DirectX::XMFLOAT3>& positions);
+
+	//Largest distance along an axis between a position in the box and its decoded value
+	float MaxPositionError(const VertexDecode& decode);
+	//Largest angle (radians) between a unit normal and its decoded octahedral encoding
+	constexpr float MaxNormalAngleError = 5e-5f;
+
+	//Normal does not have to be unit length, zero vectors decode as +z
+	void EncodeOctahedral(const DirectX::XMFLOAT3& normal, int16_t encoded[2]);
+	DirectX::XMFLOAT3 DecodeOctahedral(const int16_t encoded[2]);
+
+	//Positions outside of the box are clamped to it
+	QuantizedVertex EncodeVertex(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& normal, const VertexDecode& decode);
+	//Same arithmetic as the vertex shader
+	void DecodeVertex(const QuantizedVertex& vertex, const VertexDecode& decode,
+		DirectX::XMFLOAT3& position, DirectX::XMFLOAT3& normal);
+}
@@ -1,4 +1,5 @@
 #include "vertexTypes.h"
+#include "particleSystem.h"
 
 using namespace DirectX;
 using namespace mini;
@@ -11,4 +12,20 @@ const D3D11_INPUT_ELEMENT_DESC VertexPositionColor::Layout[2] = {
 const D3D11_INPUT_ELEMENT_DESC VertexPositionNormal::Layout[2] = {
 	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, offsetof(VertexPositionNormal, position), 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(VertexPositionNormal, normal), D3D11_INPUT_PER_VERTEX_DATA, 0 }
-};
\ No newline at end of file
+};
+
+const D3D11_INPUT_ELEMENT_DESC VertexPositionNormalQuantized::Layout[2] = {
+	{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, offsetof(QuantizedVertex, position), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, offsetof(QuantizedVertex, normal), D3D11_INPUT_PER_VERTEX_DATA, 0 }
+};
+
+const D3D11_INPUT_ELEMENT_DESC VertexPositionHomogeneous::Layout[1] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(VertexPositionHomogeneous, position), D3D11_INPUT_PER_VERTEX_DATA, 0 }
+};
+
+const D3D11_INPUT_ELEMENT_DESC mini::ParticleVertexLayout[4] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(gk2::ParticleVertex, Pos), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "POSITION", 1, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(gk2::ParticleVertex, PrevPos), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32_FLOAT, 0, offsetof(gk2::ParticleVertex, Age), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 1, DXGI_FORMAT_R32_FLOAT, 0, offsetof(gk2::ParticleVertex, Size), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
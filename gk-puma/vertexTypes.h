@@ -8,6 +8,7 @@
 
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include "vertexQuantization.h"
 
 namespace mini
 {
@@ -31,4 +32,22 @@ namespace mini
 		{
 		}
 	};
+
+	//12-byte vertex with the position inside the mesh box and an octahedral normal,
+	//decoded by phongVS with the mesh VertexDecode
+	struct VertexPositionNormalQuantized : QuantizedVertex
+	{
+		static const D3D11_INPUT_ELEMENT_DESC Layout[2];
+	};
+
+	//Homogeneous position only, used by shadow volumes (w = 0 for points at infinity)
+	struct VertexPositionHomogeneous
+	{
+		DirectX::XMFLOAT4 position;
+
+		static const D3D11_INPUT_ELEMENT_DESC Layout[1];
+	};
+
+	//Layout of gk2::ParticleVertex, kept out of particleSystem.h so that the simulation builds without Direct3D
+	extern const D3D11_INPUT_ELEMENT_DESC ParticleVertexLayout[4];
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "assetLoader.h"
+#include "meshFile.h"
+
+using namespace mini;
+using namespace std::chrono;
+
+TEST(AssetLoaderTest, LoadsRunInParallel)
+{
+	JobSystem jobs(4);
+	AssetLoader assets(jobs);
+	auto start = steady_clock::now();
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 8; ++i)
+		results.push_back(assets.Load([i] { std::this_thread::sleep_for(milliseconds(50)); return i; }));
+	for (int i = 0; i < 8; ++i)
+		EXPECT_EQ(assets.Get(results[i]), i);
+	// 4 workers and the waiting thread: two rounds instead of eight
+	EXPECT_LT(steady_clock::now() - start, milliseconds(8 * 50));
+}
+
+TEST(AssetLoaderTest, WaitingThreadRunsLoads)
+{
+	// the only worker is blocked until a load queued after the blocking one has run
+	JobSystem jobs(1);
+	AssetLoader assets(jobs);
+	std::atomic<bool> started{ false }, released{ false };
+	auto blocker = assets.Load([&] { started = true; while (!released) std::this_thread::yield(); return 0; });
+	while (!started)
+		std::this_thread::yield();
+	auto releaser = assets.Load([&] { released = true; return 1; });
+	EXPECT_EQ(assets.Get(releaser), 1);
+	EXPECT_EQ(assets.Get(blocker), 0);
+}
+
+TEST(AssetLoaderTest, FailedLoadRethrowsOnGet)
+{
+	JobSystem jobs(2);
+	AssetLoader assets(jobs);
+	auto missing = assets.Load([] { return LoadTextMesh("no such mesh.txt"); });
+	EXPECT_THROW(assets.Get(missing), std::runtime_error);
+}
+
+TEST(AssetLoaderTest, ParallelMeshesMatchSerial)
+{
+	JobSystem jobs(3);
+	AssetLoader assets(jobs);
+	std::vector<std::future<MeshData>> meshes;
+	auto path = [](int i) { return std::filesystem::path(PUMA_MESH_DIR) / ("mesh" + std::to_string(i) + ".txt"); };
+	for (int i = 1; i <= 6; ++i)
+		meshes.push_back(assets.Load([=] { return LoadTextMesh(path(i)); }));
+	for (int i = 1; i <= 6; ++i)
+	{
+		MeshData parallel = assets.Get(meshes[i - 1]);
+		MeshData serial = LoadTextMesh(path(i));
+		ASSERT_EQ(parallel.faces.size(), serial.faces.size());
+		ASSERT_EQ(parallel.edges.size(), serial.edges.size());
+		EXPECT_EQ(0, memcmp(parallel.positions.data(), serial.positions.data(), serial.positions.size() * sizeof(DirectX::XMFLOAT3)));
+	}
+}
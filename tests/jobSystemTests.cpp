@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include "jobSystem.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+
+TEST(JobSystemTest, RunsEveryJobOnce)
+{
+	JobSystem jobs(4);
+	std::vector<std::atomic<int>> runs(10000);
+	JobCounter counter;
+	for (size_t i = 0; i < runs.size(); ++i)
+		jobs.Submit([&runs, i] { ++runs[i]; }, counter);
+	jobs.Wait(counter);
+	for (const auto& r : runs)
+		ASSERT_EQ(r.load(), 1);
+}
+
+TEST(JobSystemTest, JobsCanSubmitJobs)
+{
+	JobSystem jobs(3);
+	std::atomic<int> leaves{ 0 };
+	JobCounter counter;
+	for (int i = 0; i < 16; ++i)
+		jobs.Submit([&]
+		{
+			JobCounter inner;
+			for (int j = 0; j < 16; ++j)
+				jobs.Submit([&] { ++leaves; }, inner);
+			jobs.Wait(inner);
+		}, counter);
+	jobs.Wait(counter);
+	EXPECT_EQ(leaves.load(), 16 * 16);
+}
+
+TEST(JobSystemTest, WaitRethrowsJobException)
+{
+	JobSystem jobs(3);
+	std::atomic<int> runs{ 0 };
+	// thrown on the workers and on the waiting thread, the other jobs still run
+	EXPECT_THROW(jobs.ParallelFor(1000, [&](size_t i)
+	{
+		++runs;
+		if (i % 100 == 7)
+			throw std::runtime_error("job " + std::to_string(i));
+	}), std::runtime_error);
+	EXPECT_EQ(runs.load(), 1000);
+
+	// the counter is usable again after the exception was rethrown
+	JobCounter counter;
+	jobs.Submit([] { throw std::logic_error("first"); }, counter);
+	EXPECT_THROW(jobs.Wait(counter), std::logic_error);
+	jobs.Submit([&] { ++runs; }, counter);
+	EXPECT_NO_THROW(jobs.Wait(counter));
+	EXPECT_EQ(runs.load(), 1001);
+
+	std::future<int> result = jobs.Async([]() -> int { throw std::runtime_error("async"); }, counter);
+	EXPECT_THROW(jobs.Get(result), std::runtime_error);
+	jobs.Wait(counter);
+}
+
+TEST(JobSystemTest, ParallelShadowVolumesMatchSerial)
+{
+	std::vector<ShadowCaster> casters;
+	for (unsigned i = 0; i < 8; ++i)
+		casters.push_back(test::Torus(20 + i, 12));
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixRotationX(0.5f) * XMMatrixTranslation(0.0f, 1.0f, 0.0f));
+	const XMFLOAT3 light{ 2.0f, 3.0f, 2.0f };
+
+	std::vector<ShadowVolume> serial(casters.size()), parallel(casters.size());
+	for (size_t i = 0; i < casters.size(); ++i)
+		casters[i].GenerateShadowVolume(serial[i], light, world, 10.0f);
+	JobSystem jobs(4);
+	jobs.ParallelFor(casters.size(), [&](size_t i)
+	{
+		casters[i].GenerateShadowVolume(parallel[i], light, world, 10.0f);
+	});
+
+	for (size_t i = 0; i < casters.size(); ++i)
+	{
+		EXPECT_EQ(parallel[i].indices, serial[i].indices);
+		EXPECT_EQ(parallel[i].vertices.size(), serial[i].vertices.size());
+	}
+}
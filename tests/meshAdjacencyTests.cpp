@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "meshAdjacency.h"
+#include "meshFile.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	using EdgeKey = std::tuple<unsigned, unsigned, unsigned, unsigned>;
+
+	//Edges independent of their order and of the order of their vertices and faces
+	std::vector<EdgeKey> Sorted(const std::vector<Edge>& edges)
+	{
+		std::vector<EdgeKey> keys;
+		for (const Edge& e : edges)
+			keys.emplace_back(std::min(e.v0, e.v1), std::max(e.v0, e.v1), std::min(e.face0, e.face1), std::max(e.face0, e.face1));
+		std::sort(keys.begin(), keys.end());
+		return keys;
+	}
+
+	std::vector<XMFLOAT3> Quad()
+	{
+		return { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+	}
+}
+
+TEST(MeshAdjacencyTest, WeldingMergesSplitVertices)
+{
+	auto cube = test::Cube();
+	std::vector<XMFLOAT3> split;
+	for (const Face& face : cube.faces)
+		for (unsigned index : face.indices)
+			split.push_back(cube.vertices[index]);
+
+	WeldedPositions welded = WeldPositions(split);
+	ASSERT_EQ(welded.positions.size(), 8u);
+	ASSERT_EQ(welded.vertexPositions.size(), split.size());
+	for (size_t i = 0; i < split.size(); ++i)
+	{
+		const XMFLOAT3& p = welded.positions[welded.vertexPositions[i]];
+		EXPECT_EQ(std::make_tuple(p.x, p.y, p.z), std::make_tuple(split[i].x, split[i].y, split[i].z));
+	}
+	EXPECT_EQ(MatchPositions(welded.positions, split), welded.vertexPositions);
+}
+
+TEST(MeshAdjacencyTest, ToleranceWeldsNearbyVertices)
+{
+	// pary po obu stronach granic komorek siatki
+	std::vector<XMFLOAT3> vertices = {
+		{ 0.99995e-3f, 0.0f, 0.0f }, { 1.00004e-3f, 0.0f, 0.0f },
+		{ -0.00002e-3f, 1.0f, 1.0f }, { 0.00003e-3f, 1.0f, 1.0f },
+		{ 0.5f, 0.5f, 0.5f }, { 0.5f, 0.5f, 0.5011f },
+	};
+	EXPECT_EQ(WeldPositions(vertices).positions.size(), 6u);
+	WeldedPositions welded = WeldPositions(vertices, 1e-6f);
+	EXPECT_EQ(welded.positions.size(), 4u);
+	EXPECT_EQ(welded.vertexPositions, (std::vector<uint32_t>{ 0, 0, 1, 1, 2, 3 }));
+}
+
+TEST(MeshAdjacencyTest, EdgesMatchMeshFiles)
+{
+	for (int i = 1; i <= 6; ++i)
+	{
+		MeshData mesh = LoadBinaryMesh(std::filesystem::path(PUMA_MESH_DIR) / ("mesh" + std::to_string(i) + BinaryMeshExtension));
+		AdjacencyStats stats;
+		auto edges = BuildEdges(mesh.faces, mesh.vertexPositions, &stats);
+		EXPECT_EQ(Sorted(edges), Sorted(mesh.edges)) << "mesh" << i;
+		EXPECT_EQ(stats.boundaryEdges, 0u);
+		EXPECT_EQ(stats.nonManifoldEdges, 0u);
+	}
+}
+
+TEST(MeshAdjacencyTest, OpenEdgesAreReportedAndClosed)
+{
+	std::vector<Face> faces = { Face(0, 1, 2), Face(0, 2, 3) };
+	std::vector<uint32_t> vertexPositions = { 0, 1, 2, 3 };
+	AdjacencyStats stats;
+	auto edges = BuildEdges(faces, vertexPositions, &stats);
+	EXPECT_EQ(edges.size(), 5u);
+	EXPECT_EQ(stats.boundaryEdges, 4u);
+
+	EXPECT_EQ(CloseBoundaries(faces, edges), 2u);
+	ASSERT_EQ(faces.size(), 4u);
+	// odwrocona kopia sciany
+	EXPECT_EQ(faces[2].indices[1], 2u);
+	EXPECT_EQ(faces[2].indices[2], 1u);
+	EXPECT_EQ(edges.size(), 6u);
+	std::vector<int> faceEdges(faces.size());
+	for (const Edge& e : edges)
+	{
+		ASSERT_NE(e.face1, UINT_MAX);
+		++faceEdges[e.face0];
+		++faceEdges[e.face1];
+	}
+	EXPECT_EQ(faceEdges, (std::vector<int>{ 3, 3, 3, 3 }));
+	EXPECT_EQ(CloseBoundaries(faces, edges), 0u);
+}
+
+TEST(MeshAdjacencyTest, OnlyOpenPartsAreDoubled)
+{
+	auto cube = test::Cube();
+	std::vector<Face> faces = cube.faces;
+	std::vector<uint32_t> vertexPositions(8);
+	for (uint32_t i = 0; i < 8; ++i)
+		vertexPositions[i] = i;
+	vertexPositions.insert(vertexPositions.end(), { 8, 9, 10 });
+	faces.emplace_back(8, 9, 10);
+
+	auto edges = BuildEdges(faces, vertexPositions);
+	EXPECT_EQ(CloseBoundaries(faces, edges), 1u);
+	EXPECT_EQ(edges.size(), cube.edges.size() + 3);
+}
+
+TEST(MeshAdjacencyTest, NonManifoldEdgesPairFaces)
+{
+	// cztery trojkaty wokol jednej krawedzi (0, 1)
+	std::vector<Face> faces = { Face(0, 1, 2), Face(1, 0, 3), Face(0, 1, 4), Face(1, 0, 5) };
+	std::vector<uint32_t> vertexPositions = { 0, 1, 2, 3, 4, 5 };
+	AdjacencyStats stats;
+	auto edges = BuildEdges(faces, vertexPositions, &stats);
+	EXPECT_EQ(stats.nonManifoldEdges, 1u);
+	std::vector<EdgeKey> shared;
+	for (const auto& key : Sorted(edges))
+		if (std::get<0>(key) == 0 && std::get<1>(key) == 1)
+			shared.push_back(key);
+	EXPECT_EQ(shared, (std::vector<EdgeKey>{ { 0, 1, 0, 1 }, { 0, 1, 2, 3 } }));
+}
+
+TEST(MeshAdjacencyTest, DegenerateEdgesAreSkipped)
+{
+	auto quad = Quad();
+	quad.push_back(quad[2]);
+	std::vector<Face> faces = { Face(0, 1, 2), Face(0, 2, 3), Face(1, 4, 2) };
+	WeldedPositions welded = WeldPositions(quad);
+	AdjacencyStats stats;
+	auto edges = BuildEdges(faces, welded.vertexPositions, &stats);
+	EXPECT_EQ(edges.size(), 5u);
+	EXPECT_EQ(stats.boundaryEdges, 4u);
+	EXPECT_EQ(stats.nonManifoldEdges, 0u);
+}
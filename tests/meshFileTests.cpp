@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "meshFile.h"
+#include "textParser.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	std::filesystem::path TempPath(const std::string& name)
+	{
+		return std::filesystem::temp_directory_path() / ("puma_" + name);
+	}
+
+	void ExpectEqual(const MeshView& a, const MeshView& b)
+	{
+		ASSERT_EQ(a.positions.size, b.positions.size);
+		ASSERT_EQ(a.vertexPositions.size, b.vertexPositions.size);
+		ASSERT_EQ(a.faces.size, b.faces.size);
+		ASSERT_EQ(a.edges.size, b.edges.size);
+		EXPECT_EQ(0, memcmp(a.positions.data, b.positions.data, a.positions.size * sizeof(XMFLOAT3)));
+		EXPECT_EQ(0, memcmp(a.vertexPositions.data, b.vertexPositions.data, a.vertexPositions.size * sizeof(uint32_t)));
+		EXPECT_EQ(0, memcmp(a.normals.data, b.normals.data, a.normals.size * sizeof(XMFLOAT3)));
+		EXPECT_EQ(0, memcmp(a.faces.data, b.faces.data, a.faces.size * sizeof(Face)));
+		EXPECT_EQ(0, memcmp(a.edges.data, b.edges.data, a.edges.size * sizeof(Edge)));
+	}
+
+	MeshData Triangle()
+	{
+		MeshData mesh;
+		mesh.positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+		mesh.vertexPositions = { 0, 1, 2 };
+		mesh.normals.assign(3, { 0.0f, 0.0f, -1.0f });
+		mesh.faces = { Face(0, 1, 2) };
+		mesh.edges = { Edge(0, 1, 0, UINT_MAX), Edge(1, 2, 0, UINT_MAX), Edge(0, 2, 0, UINT_MAX) };
+		return mesh;
+	}
+}
+
+TEST(MeshFileTest, BinaryMeshMatchesTextMesh)
+{
+	for (int i = 1; i <= 6; ++i)
+	{
+		auto text = std::filesystem::path(PUMA_MESH_DIR) / ("mesh" + std::to_string(i) + ".txt");
+		MeshData mesh = LoadTextMesh(text);
+		auto binary = TempPath("mesh" + std::to_string(i) + BinaryMeshExtension);
+		SaveBinaryMesh(MeshView(mesh), binary);
+
+		MappedFile file(binary);
+		MeshView view = ViewBinaryMesh(file);
+		ExpectEqual(view, MeshView(mesh));
+		// tablice wyrownane - uzywane wprost z odwzorowanego pliku
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(view.positions.data) % BinaryMeshAlignment, 0u);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(view.edges.data) % BinaryMeshAlignment, 0u);
+		std::filesystem::remove(binary);
+	}
+}
+
+TEST(MeshFileTest, TextMeshMatchesConvertedBinaryMesh)
+{
+	// pliki .pmesh zostaly wygenerowane przez wczesniejszy loader oparty na strumieniach
+	for (int i = 1; i <= 6; ++i)
+	{
+		auto name = std::filesystem::path(PUMA_MESH_DIR) / ("mesh" + std::to_string(i));
+		MeshData text = LoadTextMesh(name.string() + ".txt");
+		MeshData binary = LoadBinaryMesh(name.string() + BinaryMeshExtension);
+		ExpectEqual(MeshView(text), MeshView(binary));
+	}
+}
+
+TEST(MeshFileTest, LoadsIndexedTextMesh)
+{
+	IndexedMeshData teapot = LoadIndexedTextMesh(std::filesystem::path(PUMA_MESH_DIR) / "teapot.mesh");
+	EXPECT_EQ(teapot.positions.size(), 530u);
+	EXPECT_EQ(teapot.normals.size(), 530u);
+	EXPECT_EQ(teapot.texCoords.size(), 530u);
+	EXPECT_EQ(teapot.indices.size(), 3072u);
+	EXPECT_EQ(teapot.positions[0].x, 2.1f);
+	EXPECT_EQ(teapot.positions[0].y, 3.6f);
+}
+
+TEST(MeshFileTest, TextMeshRoundTrips)
+{
+	MeshData mesh = LoadTextMesh(std::filesystem::path(PUMA_MESH_DIR) / "mesh2.txt");
+	auto path = TempPath("roundtrip.txt");
+	SaveTextMesh(MeshView(mesh), path);
+	MeshData loaded = LoadTextMesh(path);
+	ExpectEqual(MeshView(loaded), MeshView(mesh));
+	std::filesystem::remove(path);
+}
+
+TEST(MeshFileTest, MalformedBinaryMeshIsRejected)
+{
+	auto path = TempPath("malformed.pmesh");
+	SaveBinaryMesh(MeshView(Triangle()), path);
+	std::string bytes;
+	{
+		std::ifstream input(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(input), {});
+	}
+	auto check = [&](const std::string& contents)
+	{
+		std::ofstream(path, std::ios::binary | std::ios::trunc).write(contents.data(), contents.size());
+		MappedFile file(path);
+		EXPECT_THROW(ViewBinaryMesh(file), std::runtime_error);
+	};
+
+	check(bytes.substr(0, bytes.size() - 4));
+	check("");
+	std::string wrongMagic = bytes;
+	wrongMagic[0] = 'X';
+	check(wrongMagic);
+	std::string newerVersion = bytes;
+	++newerVersion[offsetof(BinaryMeshHeader, version)];
+	check(newerVersion);
+	// krawedz wskazujaca nieistniejaca sciane
+	MeshData badEdge = Triangle();
+	badEdge.edges[0].face1 = 5;
+	SaveBinaryMesh(MeshView(badEdge), path);
+	MappedFile file(path);
+	EXPECT_THROW(ViewBinaryMesh(file), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(MeshFileTest, TruncatedTextMeshIsRejected)
+{
+	auto path = TempPath("truncated.txt");
+	std::ofstream(path) << "3\n0 0 0\n1 0 0\n";
+	EXPECT_THROW(LoadTextMesh(path), TextParseError);
+	std::ofstream(path) << "1\n0 0 0\n1\n5 0 0 1\n0\n0\n";
+	EXPECT_THROW(LoadTextMesh(path), std::runtime_error);
+	EXPECT_THROW(LoadTextMesh(TempPath("missing.txt")), std::runtime_error);
+	std::filesystem::remove(path);
+}
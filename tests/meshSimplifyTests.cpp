@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "meshAdjacency.h"
+#include "meshSimplify.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	//Cube [0, n]^3 with every side split into n x n quads, outward winding
+	void GridCube(unsigned n, std::vector<XMFLOAT3>& positions, std::vector<Face>& faces)
+	{
+		std::map<std::tuple<unsigned, unsigned, unsigned>, unsigned> index;
+		auto vertex = [&](unsigned axis, unsigned side, unsigned i, unsigned j)
+		{
+			unsigned p[3];
+			p[axis] = side;
+			p[(axis + 1) % 3] = i;
+			p[(axis + 2) % 3] = j;
+			auto [it, added] = index.emplace(std::make_tuple(p[0], p[1], p[2]), static_cast<unsigned>(positions.size()));
+			if (added)
+				positions.push_back({ float(p[0]), float(p[1]), float(p[2]) });
+			return it->second;
+		};
+		for (unsigned axis = 0; axis < 3; ++axis)
+			for (unsigned side : { 0u, n })
+				for (unsigned i = 0; i < n; ++i)
+					for (unsigned j = 0; j < n; ++j)
+					{
+						unsigned a = vertex(axis, side, i, j), b = vertex(axis, side, i + 1, j);
+						unsigned c = vertex(axis, side, i + 1, j + 1), d = vertex(axis, side, i, j + 1);
+						// (i, j) -> (i + 1, j) -> (i + 1, j + 1) ma normalna +axis
+						if (side)
+						{
+							faces.emplace_back(a, b, c);
+							faces.emplace_back(a, c, d);
+						}
+						else
+						{
+							faces.emplace_back(a, c, b);
+							faces.emplace_back(a, d, c);
+						}
+					}
+	}
+
+	AdjacencyStats Stats(const SimplifiedMesh& mesh)
+	{
+		std::vector<uint32_t> identity(mesh.positions.size());
+		for (uint32_t i = 0; i < identity.size(); ++i)
+			identity[i] = i;
+		AdjacencyStats stats;
+		std::vector<Edge> edges = BuildEdges(mesh.faces, identity, &stats);
+		EXPECT_EQ(2 * edges.size(), 3 * mesh.faces.size());
+		return stats;
+	}
+
+	XMVECTOR FaceNormal(const std::vector<XMFLOAT3>& positions, const Face& face)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&positions[face.indices[0]]);
+		XMVECTOR p1 = XMLoadFloat3(&positions[face.indices[1]]);
+		XMVECTOR p2 = XMLoadFloat3(&positions[face.indices[2]]);
+		return XMVector3Cross(p1 - p0, p2 - p0);
+	}
+}
+
+TEST(MeshSimplifyTest, TorusStaysClosedAndNearSurface)
+{
+	auto torus = test::Torus(40, 30);
+	const size_t target = torus.faces.size() / 4;
+	SimplifiedMesh mesh = SimplifyMesh(torus.positions, torus.faces, target);
+	EXPECT_LE(mesh.faces.size(), target);
+	EXPECT_GT(mesh.faces.size(), target - 8);
+	EXPECT_GT(mesh.error, 0.f);
+	AdjacencyStats stats = Stats(mesh);
+	EXPECT_EQ(stats.boundaryEdges, 0u);
+	EXPECT_EQ(stats.nonManifoldEdges, 0u);
+	for (const Face& face : mesh.faces)
+		EXPECT_GT(XMVectorGetX(XMVector3LengthSq(FaceNormal(mesh.positions, face))), 0.f);
+
+	// plaszczyzny scian oryginalu odbiegaja od torusa najwyzej o strzalke luku
+	const float sagitta = 1.3f * (1.f - std::cos(3.1415927f / 40)) + 0.3f * (1.f - std::cos(3.1415927f / 30));
+	for (const XMFLOAT3& p : mesh.positions)
+	{
+		float ring = std::sqrt(p.x * p.x + p.z * p.z) - 1.f;
+		float distance = std::abs(std::sqrt(ring * ring + p.y * p.y) - 0.3f);
+		EXPECT_LE(distance, mesh.error + sagitta);
+	}
+}
+
+TEST(MeshSimplifyTest, FlatSidesCollapseWithoutError)
+{
+	std::vector<XMFLOAT3> positions;
+	std::vector<Face> faces;
+	GridCube(6, positions, faces);
+	SimplifiedMesh mesh = SimplifyMesh(positions, faces, 12);
+	EXPECT_LT(mesh.faces.size(), faces.size() / 8);
+	EXPECT_LT(mesh.error, 1e-3f);
+	AdjacencyStats stats = Stats(mesh);
+	EXPECT_EQ(stats.boundaryEdges, 0u);
+	EXPECT_EQ(stats.nonManifoldEdges, 0u);
+	const XMVECTOR center = XMVectorReplicate(3.f);
+	for (const XMFLOAT3& p : mesh.positions)
+		EXPECT_NEAR(std::max({ std::abs(p.x - 3.f), std::abs(p.y - 3.f), std::abs(p.z - 3.f) }), 3.f, 1e-3f);
+	for (const Face& face : mesh.faces)
+	{
+		XMVECTOR toFace = XMLoadFloat3(&mesh.positions[face.indices[0]]) - center;
+		EXPECT_GT(XMVectorGetX(XMVector3Dot(FaceNormal(mesh.positions, face), toFace)), 0.f);
+	}
+}
+
+TEST(MeshSimplifyTest, ErrorLimitStopsCollapses)
+{
+	auto torus = test::Torus(40, 30);
+	SimplifiedMesh unlimited = SimplifyMesh(torus.positions, torus.faces, 100);
+	SimplifiedMesh limited = SimplifyMesh(torus.positions, torus.faces, 100, unlimited.error / 4);
+	EXPECT_GT(limited.faces.size(), unlimited.faces.size());
+	EXPECT_LE(limited.error, unlimited.error / 4);
+}
+
+TEST(MeshSimplifyTest, SimplifiedCasterGeneratesShadowVolume)
+{
+	auto torus = test::Torus(40, 30);
+	float error = -1.f;
+	ShadowCaster simple = torus.Simplified(torus.faces.size() / 4, &error);
+	EXPECT_GE(error, 0.f);
+	EXPECT_LE(simple.faces.size(), torus.faces.size() / 4);
+	EXPECT_EQ(2 * simple.edges.size(), 3 * simple.faces.size());
+	EXPECT_EQ(simple.vertices.size(), simple.positions.size());
+
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixIdentity());
+	ShadowVolume volume;
+	simple.GenerateShadowVolume(volume, { 3.0f, 4.0f, 1.0f }, world, InfiniteExtrusion);
+	EXPECT_FALSE(volume.silhouette.empty());
+	EXPECT_FALSE(volume.indices.empty());
+}
+
+TEST(MeshSimplifyTest, LodSelectionFollowsDistance)
+{
+	auto torus = test::Torus(100, 50);
+	ShadowLodChain lods;
+	lods.Build(torus);
+	ASSERT_GT(lods.Levels(), 3u);
+	for (size_t level = 1; level < lods.Levels(); ++level)
+	{
+		size_t previous = level == 1 ? torus.faces.size() : lods.Level(level - 1).faces.size();
+		EXPECT_LE(lods.Level(level).faces.size(), previous * 3 / 4);
+		EXPECT_GE(lods.Level(level).faces.size(), 64u);
+		EXPECT_GE(lods.Error(level), lods.Error(level - 1));
+	}
+
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixIdentity());
+	LodView view = { { 0.f, 0.f, 0.f }, 500.f, 1.f };
+	EXPECT_EQ(lods.Select(view, world), 0u);
+	size_t previous = 0;
+	for (float distance = 2.f; distance < 1e5f; distance *= 2.f)
+	{
+		view.eye = { 0.f, distance, 0.f };
+		size_t level = lods.Select(view, world);
+		EXPECT_GE(level, previous) << "distance " << distance;
+		previous = level;
+	}
+	EXPECT_EQ(previous, lods.Levels() - 1);
+
+	// skalowanie obiektu przybliza go na ekranie
+	view.eye = { 0.f, 50.f, 0.f };
+	XMStoreFloat4x4(&world, XMMatrixScaling(4.f, 4.f, 4.f));
+	size_t scaled = lods.Select(view, world);
+	XMStoreFloat4x4(&world, XMMatrixIdentity());
+	EXPECT_LE(scaled, lods.Select(view, world));
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "meshlets.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	std::vector<SimdLevel> SupportedLevels()
+	{
+		std::vector<SimdLevel> levels{ SimdLevel::Scalar };
+		if (DetectSimdLevel() >= SimdLevel::SSE4)
+			levels.push_back(SimdLevel::SSE4);
+		if (DetectSimdLevel() >= SimdLevel::AVX2)
+			levels.push_back(SimdLevel::AVX2);
+		return levels;
+	}
+
+	//Faces as sorted rotations of their indices, independent of the face order
+	std::vector<std::array<unsigned, 3>> SortedFaces(const std::vector<Face>& faces)
+	{
+		std::vector<std::array<unsigned, 3>> result;
+		for (const Face& f : faces)
+		{
+			std::array<unsigned, 3> t{ f.indices[0], f.indices[1], f.indices[2] };
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			result.push_back(t);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	bool HasVertex(const Face& face, unsigned v)
+	{
+		return std::find(std::begin(face.indices), std::end(face.indices), v) != std::end(face.indices);
+	}
+
+	//n . (p - point) for a face: positive if turned away from point
+	float AwayDistance(const ShadowCaster& caster, const Face& face, XMFLOAT3 point)
+	{
+		XMVECTOR p0 = XMLoadFloat3(&caster.vertices[face.indices[0]]);
+		XMVECTOR p1 = XMLoadFloat3(&caster.vertices[face.indices[1]]);
+		XMVECTOR p2 = XMLoadFloat3(&caster.vertices[face.indices[2]]);
+		XMVECTOR n = XMVector3Normalize(XMVector3Cross(p1 - p0, p2 - p0));
+		return XMVectorGetX(XMVector3Dot(n, p0 - XMLoadFloat3(&point)));
+	}
+}
+
+TEST(MeshletTest, PartitionKeepsFacesAndGroupsEdges)
+{
+	auto torus = test::Torus(40, 30);
+	const auto original = torus;
+	std::vector<Meshlet> meshlets = BuildMeshlets(torus.vertices, torus.faces, torus.edges);
+	ASSERT_FALSE(meshlets.empty());
+	EXPECT_EQ(SortedFaces(torus.faces), SortedFaces(original.faces));
+	ASSERT_EQ(torus.edges.size(), original.edges.size());
+
+	// meshlety pokrywaja sciany po kolei
+	std::vector<uint32_t> meshletOf(torus.faces.size());
+	uint32_t nextFace = 0, nextEdge = 0;
+	for (uint32_t m = 0; m < meshlets.size(); ++m)
+	{
+		EXPECT_EQ(meshlets[m].firstFace, nextFace);
+		EXPECT_GT(meshlets[m].faceCount, 0u);
+		EXPECT_LE(meshlets[m].faceCount, MeshletMaxFaces);
+		EXPECT_EQ(meshlets[m].firstEdge, nextEdge);
+		std::fill_n(meshletOf.begin() + meshlets[m].firstFace, meshlets[m].faceCount, m);
+		nextFace += meshlets[m].faceCount;
+		nextEdge += meshlets[m].edgeCount;
+	}
+	EXPECT_EQ(nextFace, torus.faces.size());
+	EXPECT_EQ(MeshletBorderEdges(meshlets), nextEdge);
+	// most faces end up in full meshlets on a smooth mesh
+	EXPECT_LT(meshlets.size(), torus.faces.size() / 32);
+
+	for (uint32_t e = 0; e < torus.edges.size(); ++e)
+	{
+		const Edge& edge = torus.edges[e];
+		// torus vertices are its positions
+		for (unsigned f : { edge.face0, edge.face1 })
+			EXPECT_TRUE(HasVertex(torus.faces[f], edge.v0) && HasVertex(torus.faces[f], edge.v1)) << "edge " << e;
+		bool inner = meshletOf[edge.face0] == meshletOf[edge.face1];
+		EXPECT_EQ(inner, e < nextEdge) << "edge " << e;
+		if (inner)
+		{
+			const Meshlet& m = meshlets[meshletOf[edge.face0]];
+			EXPECT_TRUE(e >= m.firstEdge && e < m.firstEdge + m.edgeCount) << "edge " << e;
+		}
+	}
+}
+
+TEST(MeshletTest, BoundsContainFacesAndNormals)
+{
+	auto torus = test::Torus(40, 30);
+	std::vector<Meshlet> meshlets = BuildMeshlets(torus.vertices, torus.faces, torus.edges);
+	size_t narrowCones = 0;
+	for (const Meshlet& m : meshlets)
+	{
+		bool narrow = m.coneCutoff <= 1.0f;
+		narrowCones += narrow;
+		float minCos = narrow ? std::sqrt(1.0f - m.coneCutoff * m.coneCutoff) : -1.0f;
+		for (uint32_t f = m.firstFace; f < m.firstFace + m.faceCount; ++f)
+		{
+			const Face& face = torus.faces[f];
+			for (unsigned v : face.indices)
+			{
+				float d = XMVectorGetX(XMVector3Length(XMLoadFloat3(&torus.vertices[v]) - XMLoadFloat3(&m.center)));
+				EXPECT_LE(d, m.radius * 1.0001f);
+			}
+			XMVECTOR p0 = XMLoadFloat3(&torus.vertices[face.indices[0]]);
+			XMVECTOR p1 = XMLoadFloat3(&torus.vertices[face.indices[1]]);
+			XMVECTOR p2 = XMLoadFloat3(&torus.vertices[face.indices[2]]);
+			XMVECTOR n = XMVector3Normalize(XMVector3Cross(p1 - p0, p2 - p0));
+			EXPECT_GE(XMVectorGetX(XMVector3Dot(n, XMLoadFloat3(&m.coneAxis))), minCos - 1e-5f);
+		}
+	}
+	EXPECT_EQ(narrowCones, meshlets.size());
+}
+
+TEST(MeshletTest, ClassificationIsConservative)
+{
+	auto torus = test::Torus(40, 30);
+	torus.BuildMeshlets();
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> coord(-6.0f, 6.0f);
+	size_t decided = 0;
+	for (int i = 0; i < 50; ++i)
+	{
+		XMFLOAT3 point{ coord(rng), coord(rng), coord(rng) };
+		for (const Meshlet& m : torus.Meshlets())
+		{
+			MeshletSide side = ClassifyMeshlet(m, point);
+			if (side == MeshletSide::Mixed)
+				continue;
+			++decided;
+			for (uint32_t f = m.firstFace; f < m.firstFace + m.faceCount; ++f)
+			{
+				float away = AwayDistance(torus, torus.faces[f], point);
+				EXPECT_TRUE(side == MeshletSide::Back ? away > 0.0f : away < 0.0f) << "face " << f;
+			}
+		}
+	}
+	EXPECT_GT(decided, 0u);
+}
+
+TEST(MeshletTest, SilhouetteMatchesFullScan)
+{
+	auto torus = test::Torus(40, 30);
+	torus.BuildMeshlets();
+	FacePlanes planes;
+	EdgeFaces edgeFaces;
+	planes.Build(torus.vertices, torus.faces);
+	edgeFaces.Build(torus.edges);
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> coord(-8.0f, 8.0f);
+	size_t skipped = 0;
+	for (int i = 0; i < 30; ++i)
+	{
+		XMFLOAT3 light{ coord(rng), coord(rng), coord(rng) };
+		for (bool flip : { false, true })
+			for (SimdLevel level : SupportedLevels())
+			{
+				FaceBitset expected, facing;
+				std::vector<uint32_t> expectedEdges, silhouette;
+				ClassifyFaces(planes, light, flip, expected, level);
+				GatherSilhouetteEdges(edgeFaces, expected, expectedEdges, level);
+				skipped += GatherMeshletSilhouette(torus.Meshlets(), planes, edgeFaces, light, flip, facing, silhouette, level);
+				ASSERT_EQ(facing.size(), expected.size());
+				for (size_t f = 0; f < planes.count; ++f)
+					ASSERT_EQ(facing[f], expected[f]) << "face " << f;
+				EXPECT_EQ(silhouette, expectedEdges);
+			}
+	}
+	EXPECT_GT(skipped, 0u);
+}
+
+TEST(MeshletTest, ShadowVolumeIsUnchanged)
+{
+	auto plain = test::Torus(20, 25);
+	auto clustered = plain;
+	clustered.BuildMeshlets();
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixScaling(1.0f, 1.0f, -1.0f) * XMMatrixTranslation(0.0f, 0.5f, 0.0f));
+	ShadowVolume expected, volume;
+	plain.GenerateShadowVolume(expected, { 3.0f, 4.0f, 1.0f }, world, InfiniteExtrusion);
+	clustered.GenerateShadowVolume(volume, { 3.0f, 4.0f, 1.0f }, world, InfiniteExtrusion);
+	EXPECT_GT(volume.skippedMeshlets, 0u);
+	EXPECT_EQ(volume.silhouette.size(), expected.silhouette.size());
+	EXPECT_EQ(volume.indices.size(), expected.indices.size());
+	EXPECT_EQ(volume.vertices.size(), expected.vertices.size());
+	EXPECT_EQ(volume.facing.count(), expected.facing.count());
+}
+
+TEST(MeshletTest, BackFacingMeshletsAreCulled)
+{
+	auto torus = test::Torus(40, 30);
+	torus.BuildMeshlets();
+	const XMFLOAT3 eye{ 0.0f, 5.0f, 0.5f };
+	std::vector<FaceRange> ranges;
+	size_t culled = VisibleMeshletFaces(torus.Meshlets(), eye, ranges);
+	EXPECT_GT(culled, 0u);
+
+	std::vector<uint8_t> visible(torus.faces.size(), 0);
+	size_t visibleFaces = 0;
+	for (size_t i = 0; i < ranges.size(); ++i)
+	{
+		// consecutive visible meshlets are merged
+		if (i > 0)
+		{
+			EXPECT_GT(ranges[i].first, ranges[i - 1].first + ranges[i - 1].count);
+		}
+		std::fill_n(visible.begin() + ranges[i].first, ranges[i].count, 1);
+		visibleFaces += ranges[i].count;
+	}
+	size_t culledFaces = 0;
+	for (const Meshlet& m : torus.Meshlets())
+		if (!visible[m.firstFace])
+			culledFaces += m.faceCount;
+	EXPECT_EQ(visibleFaces + culledFaces, torus.faces.size());
+	for (size_t f = 0; f < torus.faces.size(); ++f)
+		if (!visible[f])
+		{
+			EXPECT_GT(AwayDistance(torus, torus.faces[f], eye), 0.0f) << "face " << f;
+		}
+}
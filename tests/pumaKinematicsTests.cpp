@@ -0,0 +1,443 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "pumaKinematics.h"
+#include "vectorMath.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	//Chain of the link matrices as written originally in Puma::UpdateManipulatorMtx
+	void ReferenceLinks(const float a[PumaJointCount], XMMATRIX mtx[PumaLinkCount])
+	{
+		mtx[0] = XMMatrixIdentity();
+		mtx[1] = XMMatrixRotationY(a[0]);
+		mtx[2] = XMMatrixTranslation(0, -0.27f, 0) * XMMatrixRotationZ(a[1]) * XMMatrixTranslation(0, 0.27f, 0) * mtx[1];
+		mtx[3] = XMMatrixTranslation(0.91f, -0.27f, 0) * XMMatrixRotationZ(a[2]) * XMMatrixTranslation(-0.91f, 0.27f, 0) * mtx[2];
+		mtx[4] = XMMatrixTranslation(0, -0.27f, 0.26f) * XMMatrixRotationX(a[3]) * XMMatrixTranslation(0, 0.27f, -0.26f) * mtx[3];
+		mtx[5] = XMMatrixTranslation(1.72f, -0.27f, 0) * XMMatrixRotationZ(a[4]) * XMMatrixTranslation(-1.72f, 0.27f, 0) * mtx[4];
+	}
+
+	JointBatch RandomAngles(size_t count, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		JointBatch batch;
+		batch.resize(count);
+		for (auto& a : batch.angles)
+			for (size_t i = 0; i < count; ++i)
+				a[i] = angle(rng);
+		return batch;
+	}
+
+	void ExpectNear(XMFLOAT3 actual, XMVECTOR expected, float tolerance)
+	{
+		EXPECT_NEAR(actual.x, XMVectorGetX(expected), tolerance);
+		EXPECT_NEAR(actual.y, XMVectorGetY(expected), tolerance);
+		EXPECT_NEAR(actual.z, XMVectorGetZ(expected), tolerance);
+	}
+}
+
+TEST(PumaKinematicsTest, LinkMatricesMatchOriginalChain)
+{
+	PumaKinematics kinematics;
+	JointBatch batch = RandomAngles(50, 1);
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		float a[PumaJointCount];
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			a[j] = batch.angles[j][i];
+		XMFLOAT4X4 links[PumaLinkCount];
+		XMMATRIX expected[PumaLinkCount];
+		kinematics.LinkMatrices(a, links);
+		ReferenceLinks(a, expected);
+		for (size_t l = 0; l < PumaLinkCount; ++l)
+		{
+			XMFLOAT4X4 e;
+			XMStoreFloat4x4(&e, expected[l]);
+			for (int r = 0; r < 4; ++r)
+				for (int c = 0; c < 4; ++c)
+					EXPECT_NEAR(links[l].m[r][c], e.m[r][c], 1e-5f) << "link " << l;
+		}
+	}
+}
+
+TEST(PumaKinematicsTest, ToolMovesWithLastLink)
+{
+	PumaKinematics kinematics;
+	const XMFLOAT3 restPosition = kinematics.RestToolPosition(), restNormal = kinematics.RestToolNormal();
+	XMFLOAT3 p, n;
+	const float rest[PumaJointCount] = {};
+	kinematics.ForwardKinematics(rest, p, n);
+	ExpectNear(p, XMLoadFloat3(&restPosition), 0.f);
+	ExpectNear(n, XMLoadFloat3(&restNormal), 0.f);
+	EXPECT_NEAR(p.x, -2.05f, 1e-6f);
+
+	JointBatch batch = RandomAngles(50, 2);
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		float a[PumaJointCount];
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			a[j] = batch.angles[j][i];
+		XMFLOAT4X4 links[PumaLinkCount];
+		kinematics.LinkMatrices(a, links);
+		kinematics.ForwardKinematics(a, p, n);
+		XMMATRIX m = XMLoadFloat4x4(&links[PumaLinkCount - 1]);
+		ExpectNear(p, XMVector3TransformCoord(XMLoadFloat3(&restPosition), m), 1e-5f);
+		ExpectNear(n, XMVector3TransformNormal(XMLoadFloat3(&restNormal), m), 1e-5f);
+	}
+}
+
+TEST(PumaKinematicsTest, BatchMatchesSingleConfigurations)
+{
+	PumaKinematics kinematics;
+	JointBatch batch = RandomAngles(1003, 3);
+	ToolBatch tools;
+	kinematics.ForwardKinematics(batch, tools);
+	ASSERT_EQ(tools.count, batch.count);
+	ASSERT_EQ(tools.px.size() % KinematicsBlock, 0u);
+
+	// zakresy zaczynajace i konczace sie w srodku bloku
+	ToolBatch ranges;
+	ranges.resize(batch.count);
+	for (size_t first : { 0u, 5u, 402u, 1001u })
+		kinematics.ForwardKinematics(batch, first, std::min<size_t>(397, batch.count - first), ranges);
+
+	for (size_t i = 0; i < batch.count; ++i)
+	{
+		float a[PumaJointCount];
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			a[j] = batch.angles[j][i];
+		XMFLOAT3 p, n;
+		kinematics.ForwardKinematics(a, p, n);
+		XMVECTOR expectedP = XMLoadFloat3(&p), expectedN = XMLoadFloat3(&n);
+		ExpectNear({ tools.px[i], tools.py[i], tools.pz[i] }, expectedP, 1e-5f);
+		ExpectNear({ tools.nx[i], tools.ny[i], tools.nz[i] }, expectedN, 1e-5f);
+		if (i < 397 || (i >= 402 && i < 799) || i >= 1001)
+			ExpectNear({ ranges.px[i], ranges.py[i], ranges.pz[i] }, expectedP, 1e-5f);
+	}
+}
+
+TEST(PumaKinematicsTest, LinkDimensionsAreData)
+{
+	PumaLinks links;
+	links.upperArm = 1.5f;
+	links.tool = 0.f;
+	PumaKinematics kinematics(links);
+	XMFLOAT3 p, n;
+	// lokiec zgiety o 90 stopni: przedramie w dol
+	const float bent[PumaJointCount] = { 0.f, 0.f, XM_PIDIV2, 0.f, 0.f };
+	kinematics.ForwardKinematics(bent, p, n);
+	EXPECT_NEAR(p.x, -1.5f, 1e-5f);
+	EXPECT_NEAR(p.y, links.shoulderHeight - links.forearm, 1e-5f);
+	EXPECT_NEAR(n.y, 1.f, 1e-5f);
+}
+
+TEST(VectorMathTest, InverseTrigStaysWithinErrorBound)
+{
+	float worst = 0.f;
+	for (int i = -2000; i <= 2000; ++i)
+	{
+		float angle = XM_PI * i / 2000;
+		for (float radius : { 1e-3f, 1.f, 250.f })
+		{
+			float y = radius * std::sin(angle), x = radius * std::cos(angle);
+			float result = XMVectorGetX(VectorATan2(XMVectorReplicate(y), XMVectorReplicate(x)));
+			worst = std::max(worst, std::abs(result - std::atan2(y, x)));
+		}
+	}
+	for (int i = -2000; i <= 2000; ++i)
+	{
+		float x = i / 2000.f;
+		worst = std::max(worst, std::abs(XMVectorGetX(VectorACos(XMVectorReplicate(x))) - std::acos(x)));
+	}
+	EXPECT_LE(worst, VectorTrigMaxError);
+	EXPECT_EQ(XMVectorGetX(VectorATan2(XMVectorZero(), XMVectorZero())), 0.f);
+	EXPECT_NEAR(XMVectorGetX(VectorACos(XMVectorReplicate(1.5f))), 0.f, VectorTrigMaxError);
+	EXPECT_NEAR(XMVectorGetX(VectorACos(XMVectorReplicate(-1.5f))), XM_PI, VectorTrigMaxError);
+}
+
+TEST(PumaKinematicsTest, InverseKinematicsReachesForwardPoses)
+{
+	PumaKinematics kinematics;
+	JointBatch configurations = RandomAngles(1003, 4);
+	ToolBatch targets;
+	kinematics.ForwardKinematics(configurations, targets);
+
+	JointBatch solved;
+	std::vector<uint8_t> reachable;
+	kinematics.InverseKinematics(targets, solved, reachable);
+	ToolBatch reached;
+	kinematics.ForwardKinematics(solved, reached);
+	for (size_t i = 0; i < targets.count; ++i)
+	{
+		XMFLOAT3 p = { targets.px[i], targets.py[i], targets.pz[i] }, n = { targets.nx[i], targets.ny[i], targets.nz[i] };
+		float a[PumaJointCount];
+		ASSERT_TRUE(kinematics.InverseKinematics(p, n, a)) << "target " << i;
+		XMFLOAT3 p1, n1;
+		kinematics.ForwardKinematics(a, p1, n1);
+		ExpectNear(p1, XMLoadFloat3(&p), 1e-4f);
+		ExpectNear(n1, XMLoadFloat3(&n), 1e-4f);
+
+		// przyblizenia funkcji odwrotnych: blad kata rzedu VectorTrigMaxError, ramie ok. 2
+		EXPECT_EQ(reachable[i], 1) << "target " << i;
+		ExpectNear({ reached.px[i], reached.py[i], reached.pz[i] }, XMLoadFloat3(&p), 1e-4f);
+		ExpectNear({ reached.nx[i], reached.ny[i], reached.nz[i] }, XMLoadFloat3(&n), 1e-4f);
+	}
+}
+
+TEST(PumaKinematicsTest, UnreachableTargetsAreReported)
+{
+	PumaKinematics kinematics;
+	// za daleko, na osi podstawy (nadgarstek blizej niz przesuniecie) i za blisko ramienia
+	const XMFLOAT3 positions[] = { { -5.f, 0.f, 0.f }, { -0.33f, 1.f, 0.f }, { -0.4f, 0.3f, -0.26f }, { -1.f, 0.5f, 0.f } };
+	const XMFLOAT3 normals[] = { { 1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f } };
+	const bool expected[] = { false, false, false, true };
+	ToolBatch targets;
+	targets.resize(std::size(positions));
+	for (size_t i = 0; i < targets.count; ++i)
+	{
+		targets.px[i] = positions[i].x; targets.py[i] = positions[i].y; targets.pz[i] = positions[i].z;
+		targets.nx[i] = normals[i].x; targets.ny[i] = normals[i].y; targets.nz[i] = normals[i].z;
+	}
+	JointBatch solved;
+	std::vector<uint8_t> reachable;
+	kinematics.InverseKinematics(targets, solved, reachable);
+	for (size_t i = 0; i < targets.count; ++i)
+	{
+		float a[PumaJointCount];
+		EXPECT_EQ(kinematics.InverseKinematics(positions[i], normals[i], a), expected[i]) << "target " << i;
+		EXPECT_EQ(reachable[i] != 0, expected[i]) << "target " << i;
+		for (size_t j = 0; j < PumaJointCount; ++j)
+		{
+			EXPECT_TRUE(std::isfinite(a[j])) << "target " << i;
+			EXPECT_TRUE(std::isfinite(solved.angles[j][i])) << "target " << i;
+		}
+	}
+}
+
+TEST(PumaKinematicsTest, InverseKinematicsRangesMatchWholeBatch)
+{
+	// liczba celow nie jest wielokrotnoscia bloku - reachable bez dopelnienia
+	PumaKinematics kinematics;
+	JointBatch configurations = RandomAngles(5, 6);
+	ToolBatch targets;
+	kinematics.ForwardKinematics(configurations, targets);
+	JointBatch whole;
+	std::vector<uint8_t> wholeReachable;
+	kinematics.InverseKinematics(targets, whole, wholeReachable);
+	ASSERT_EQ(wholeReachable.size(), targets.count);
+
+	JointBatch ranges;
+	ranges.resize(targets.count);
+	std::vector<uint8_t> reachable(targets.count);
+	kinematics.InverseKinematics(targets, 0, 3, ranges, reachable);
+	kinematics.InverseKinematics(targets, 3, 2, ranges, reachable);
+	for (size_t i = 0; i < targets.count; ++i)
+	{
+		EXPECT_EQ(reachable[i], wholeReachable[i]) << "target " << i;
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			EXPECT_NEAR(ranges.angles[j][i], whole.angles[j][i], 1e-4f) << "target " << i;
+	}
+}
+
+namespace
+{
+	float AngleDistance(float a, float b)
+	{
+		return std::abs(std::remainder(a - b, XM_2PI));
+	}
+
+	void ExpectReaches(const PumaKinematics& kinematics, const float angles[PumaJointCount], XMFLOAT3 p, XMFLOAT3 n)
+	{
+		XMFLOAT3 p1, n1;
+		kinematics.ForwardKinematics(angles, p1, n1);
+		ExpectNear(p1, XMLoadFloat3(&p), 1e-4f);
+		ExpectNear(n1, XMLoadFloat3(&n), 1e-4f);
+	}
+}
+
+TEST(PumaKinematicsTest, AllBranchesReachTheTarget)
+{
+	PumaKinematics kinematics;
+	JointBatch configurations = RandomAngles(300, 5);
+	ToolBatch targets;
+	kinematics.ForwardKinematics(configurations, targets);
+	size_t wellConditioned = 0;
+	for (size_t i = 0; i < targets.count; ++i)
+	{
+		XMFLOAT3 p = { targets.px[i], targets.py[i], targets.pz[i] }, n = { targets.nx[i], targets.ny[i], targets.nz[i] };
+		IkSolution solutions[PumaBranchCount];
+		ASSERT_TRUE(kinematics.InverseKinematicsBranches(p, n, solutions)) << "target " << i;
+		for (unsigned b = 0; b < PumaBranchCount; ++b)
+		{
+			EXPECT_EQ(solutions[b].branch, b);
+			EXPECT_GE(solutions[b].conditioning, 0.f);
+			EXPECT_LE(solutions[b].conditioning, 1.f);
+			SCOPED_TRACE("target " + std::to_string(i) + " branch " + std::to_string(b));
+			ExpectReaches(kinematics, solutions[b].angles, p, n);
+		}
+		// poza osobliwosciami galezie sa rozne
+		if (solutions[0].conditioning < 0.05f)
+			continue;
+		++wellConditioned;
+		float single[PumaJointCount];
+		kinematics.InverseKinematics(p, n, single);
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			EXPECT_LE(AngleDistance(solutions[0].angles[j], single[j]), 1e-4f) << "target " << i;
+		for (unsigned b = 0; b < PumaBranchCount; ++b)
+			for (unsigned c = b + 1; c < PumaBranchCount; ++c)
+			{
+				float difference = 0.f;
+				for (size_t j = 0; j < PumaJointCount; ++j)
+					difference = std::max(difference, AngleDistance(solutions[b].angles[j], solutions[c].angles[j]));
+				EXPECT_GT(difference, 1e-2f) << "target " << i << " branches " << b << ", " << c;
+			}
+	}
+	EXPECT_GT(wellConditioned, targets.count / 2);
+}
+
+TEST(PumaKinematicsTest, NearestBranchFollowsTrajectory)
+{
+	PumaKinematics kinematics;
+	const struct { float start[PumaJointCount]; bool wristCrossing; } paths[] = {
+		// ramie siegajace do tylu, lokiec w gore, nadgarstek odwrocony (galaz 7)
+		{ { 2.5f, -2.6f, 1.4f, 0.4f, -1.9f }, false },
+		// galaz 0, a4 przechodzi przez 0 miedzy krokami
+		{ { 0.3f, -0.4f, -1.0f, 0.4f, 0.905f }, true },
+	};
+	const float velocity[PumaJointCount] = { 0.8f, 0.3f, -0.4f, 1.5f, -1.f };
+	for (const auto& path : paths)
+	{
+		float previous[PumaJointCount], branchZeroPrevious[PumaJointCount];
+		std::copy(std::begin(path.start), std::end(path.start), previous);
+		size_t branchZeroJumps = 0;
+		for (int step = 0; step <= 100; ++step)
+		{
+			float expected[PumaJointCount];
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				expected[j] = path.start[j] + velocity[j] * step * 0.01f;
+			XMFLOAT3 p, n;
+			kinematics.ForwardKinematics(expected, p, n);
+			IkSolution solution;
+			ASSERT_TRUE(kinematics.NearestInverseKinematics(p, n, previous, solution));
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				EXPECT_NEAR(solution.angles[j], expected[j], 1e-3f) << "step " << step << " joint " << j;
+			std::copy(std::begin(solution.angles), std::end(solution.angles), previous);
+
+			float zero[PumaJointCount];
+			kinematics.InverseKinematics(p, n, zero);
+			if (step > 0)
+				for (size_t j = 0; j < PumaJointCount; ++j)
+					branchZeroJumps += AngleDistance(zero[j], branchZeroPrevious[j]) > 0.5f;
+			std::copy(std::begin(zero), std::end(zero), branchZeroPrevious);
+		}
+		// galaz 0 obraca a3 o pi przy przejsciu nadgarstka przez osobliwosc, najblizsza galaz nie
+		EXPECT_EQ(branchZeroJumps > 0, path.wristCrossing);
+	}
+}
+
+TEST(PumaKinematicsTest, ConditioningVanishesAtSingularities)
+{
+	PumaKinematics kinematics;
+	IkSolution solutions[PumaBranchCount];
+	// wyprostowany lokiec i nadgarstek w polozeniu spoczynkowym
+	ASSERT_TRUE(kinematics.InverseKinematicsBranches(kinematics.RestToolPosition(), kinematics.RestToolNormal(), solutions));
+	EXPECT_LT(solutions[0].conditioning, 1e-2f);
+	const float bent[PumaJointCount] = { 0.3f, -0.5f, -1.2f, 0.2f, 0.9f };
+	XMFLOAT3 p, n;
+	kinematics.ForwardKinematics(bent, p, n);
+	ASSERT_TRUE(kinematics.InverseKinematicsBranches(p, n, solutions));
+	EXPECT_GT(solutions[0].conditioning, 0.3f);
+}
+
+TEST(PumaKinematicsTest, DampedLeastSquaresConvergesFromNearbyPose)
+{
+	PumaKinematics kinematics;
+	JointBatch configurations = RandomAngles(200, 6);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> offset(-0.1f, 0.1f);
+	DlsSettings settings;
+	DlsStats stats;
+	for (size_t i = 0; i < configurations.count; ++i)
+	{
+		float expected[PumaJointCount], a[PumaJointCount];
+		for (size_t j = 0; j < PumaJointCount; ++j)
+		{
+			expected[j] = configurations.angles[j][i];
+			a[j] = expected[j] + offset(rng);
+		}
+		XMFLOAT3 p, n;
+		kinematics.ForwardKinematics(expected, p, n);
+		DlsResult result = kinematics.DampedLeastSquares(p, n, a, settings, &stats);
+		EXPECT_LE(result.iterations, settings.maxIterations);
+		if (!result.converged)
+			continue;
+		EXPECT_LE(result.error, settings.tolerance);
+		XMFLOAT3 p1, n1;
+		kinematics.ForwardKinematics(a, p1, n1);
+		ExpectNear(p1, XMLoadFloat3(&p), 1e-4f);
+	}
+	// przypadkowe pozy blisko osobliwosci zbiegaja wolniej niz budzet
+	EXPECT_EQ(stats.solves, configurations.count);
+	EXPECT_GT(stats.converged, stats.solves * 9 / 10);
+	EXPECT_GT(stats.AverageMicroseconds(), 0.0);
+}
+
+TEST(PumaKinematicsTest, DampedLeastSquaresWarmStartFollowsTrajectory)
+{
+	PumaKinematics kinematics;
+	const float start[PumaJointCount] = { 0.3f, -0.4f, -1.0f, 0.4f, 0.905f };
+	const float velocity[PumaJointCount] = { 0.8f, 0.3f, -0.4f, 1.5f, -1.f };
+	float a[PumaJointCount];
+	std::copy(std::begin(start), std::end(start), a);
+	DlsStats stats;
+	for (int step = 1; step <= 100; ++step)
+	{
+		float expected[PumaJointCount];
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			expected[j] = start[j] + velocity[j] * step * 0.01f;
+		XMFLOAT3 p, n;
+		kinematics.ForwardKinematics(expected, p, n);
+		// przy osobliwosci nadgarstka (a4 = 0 miedzy krokami 90 i 91) zbieznosc jest liniowa
+		DlsResult result = kinematics.DampedLeastSquares(p, n, a, {}, &stats);
+		EXPECT_TRUE(result.converged || step == 90 || step == 91) << "step " << step;
+		EXPECT_LT(result.error, 1e-4f) << "step " << step;
+		ExpectReaches(kinematics, a, p, n);
+	}
+	// poprzednia klatka jest blisko - kilka iteracji na klatke
+	EXPECT_GE(stats.converged, stats.solves - 2);
+	EXPECT_LT(stats.AverageIterations(), 4.0);
+}
+
+TEST(PumaKinematicsTest, DampedLeastSquaresHandlesUnreachableTargets)
+{
+	PumaKinematics kinematics;
+	// za daleko i na osi podstawy, start z wyprostowanego ramienia (osobliwosc lokcia i nadgarstka)
+	const XMFLOAT3 positions[] = { { -5.f, 0.f, 0.f }, { 0.f, 3.f, 0.f }, { -0.33f, 1.f, 0.f } };
+	const XMFLOAT3 normal = { 1.f, 0.f, 0.f };
+	DlsSettings settings;
+	for (const XMFLOAT3& target : positions)
+	{
+		float a[PumaJointCount] = {};
+		XMFLOAT3 p0, n0;
+		kinematics.ForwardKinematics(a, p0, n0);
+		const float before = XMVectorGetX(XMVector3Length(XMLoadFloat3(&p0) - XMLoadFloat3(&target)));
+		float angles[PumaJointCount] = {};
+		DlsResult result = kinematics.DampedLeastSquares(target, normal, angles, settings);
+		EXPECT_FALSE(result.converged);
+		EXPECT_EQ(result.iterations, settings.maxIterations);
+		EXPECT_TRUE(std::isfinite(result.error));
+		for (float angle : angles)
+			EXPECT_TRUE(std::isfinite(angle));
+		XMFLOAT3 p1, n1;
+		kinematics.ForwardKinematics(angles, p1, n1);
+		EXPECT_LT(XMVectorGetX(XMVector3Length(XMLoadFloat3(&p1) - XMLoadFloat3(&target))), before);
+	}
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "pumaSimulation.h"
+
+using namespace mini;
+using namespace gk2;
+using namespace DirectX;
+
+namespace
+{
+	constexpr uint64_t SimulatedSteps = 600;
+
+	//Manual control of the arm in the middle of the run, then the animation again
+	ManipulatorInput InputAt(uint64_t step)
+	{
+		ManipulatorInput input;
+		if (step >= 200 && step < 260)
+		{
+			input.jointVelocity[1] = 0.5f;
+			input.jointVelocity[3] = -0.5f;
+		}
+		return input;
+	}
+
+	//Runs the simulation to SimulatedSteps with frames of the given durations, like the application does
+	template<typename FrameTime>
+	PumaSimulation Simulate(FrameTime&& frameTime)
+	{
+		PumaSimulation simulation(SceneMirrorMtx(), 3);
+		FixedStepClock clock;
+		uint64_t step = 0;
+		while (step < SimulatedSteps)
+		{
+			for (unsigned int steps = clock.Advance(frameTime()); steps > 0 && step < SimulatedSteps; --steps, ++step)
+			{
+				if (step == 300)
+					simulation.SetAnimation(true);
+				simulation.Step(static_cast<float>(clock.Step()), InputAt(step));
+			}
+		}
+		return simulation;
+	}
+
+	void ExpectIdentical(const PumaSimulation& expected, const PumaSimulation& actual)
+	{
+		EXPECT_EQ(std::memcmp(expected.Angles(), actual.Angles(), PumaJointCount * sizeof(float)), 0);
+		const auto& a = expected.Particles().particles();
+		const auto& b = actual.Particles().particles();
+		ASSERT_EQ(a.size(), b.size());
+		EXPECT_EQ(std::memcmp(a.data(), b.data(), a.size() * sizeof(Particle)), 0);
+	}
+
+	//Target of the animation at time t, as in PumaSimulation::Animate
+	void AnimationTarget(const XMFLOAT4X4& mirrorMtx, float t, XMFLOAT3& pos, XMFLOAT3& normal)
+	{
+		XMMATRIX mirror = XMLoadFloat4x4(&mirrorMtx);
+		XMStoreFloat3(&pos, XMVector3TransformCoord(XMVectorSet(0.4f * std::cos(t), 0.4f * std::sin(t), 0.f, 1.f), mirror));
+		XMStoreFloat3(&normal, XMVector3TransformNormal(XMVectorSet(0.f, 0.f, -1.f, 0.f), XMMatrixInverse(nullptr, mirror)));
+	}
+
+	std::vector<std::tuple<float, float, float>> Positions(const std::vector<ParticleVertex>& vertices)
+	{
+		std::vector<std::tuple<float, float, float>> positions;
+		for (const auto& v : vertices)
+			positions.emplace_back(v.Pos.x, v.Pos.y, v.Pos.z);
+		std::sort(positions.begin(), positions.end());
+		return positions;
+	}
+}
+
+TEST(PumaSimulationTest, FixedStepClockAccumulatesFrames)
+{
+	FixedStepClock clock(0.01, 8);
+	EXPECT_EQ(clock.Advance(0.025), 2u);
+	EXPECT_NEAR(clock.Alpha(), 0.5f, 1e-5f);
+	EXPECT_EQ(clock.Advance(0.004), 0u);
+	EXPECT_NEAR(clock.Alpha(), 0.9f, 1e-5f);
+	EXPECT_EQ(clock.Advance(0.0015), 1u);
+	EXPECT_NEAR(clock.Alpha(), 0.05f, 1e-5f);
+	EXPECT_EQ(clock.Steps(), 3u);
+	// dluga klatka - co najwyzej maxSteps krokow, reszta czasu pominieta
+	EXPECT_EQ(clock.Advance(1.0), 8u);
+	EXPECT_NEAR(clock.Alpha(), 0.f, 1e-5f);
+	EXPECT_EQ(clock.Steps(), 11u);
+}
+
+TEST(PumaSimulationTest, StateIsIdenticalAtAnyFrameRate)
+{
+	PumaSimulation reference = Simulate([] { return 1.0 / 60.0; });
+	ASSERT_GT(reference.Particles().particlesCount(), 0u);
+	ASSERT_TRUE(reference.Animation());
+	for (double fps : { 24.0, 144.0, 500.0 })
+	{
+		SCOPED_TRACE(fps);
+		ExpectIdentical(reference, Simulate([fps] { return 1.0 / fps; }));
+	}
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<double> jitter(0.001, 0.05);
+	ExpectIdentical(reference, Simulate([&] { return jitter(rng); }));
+}
+
+TEST(PumaSimulationTest, FirstAnimatedStepStartsFromBranchZero)
+{
+	PumaSimulation simulation(SceneMirrorMtx());
+	const float dt = 1.f / 120.f;
+	simulation.Step(dt);
+
+	XMFLOAT3 pos, normal;
+	AnimationTarget(SceneMirrorMtx(), dt, pos, normal);
+	float expected[PumaJointCount];
+	ASSERT_TRUE(simulation.Kinematics().InverseKinematics(pos, normal, expected));
+	for (size_t j = 0; j < PumaJointCount; ++j)
+		EXPECT_FLOAT_EQ(simulation.Angles()[j], expected[j]) << "joint " << j;
+}
+
+TEST(PumaSimulationTest, ArmStaysContinuousAcrossUnreachableTargets)
+{
+	// lustro odsuniete od ramienia - czesc okregu poza zasiegiem
+	XMFLOAT4X4 mirror;
+	XMStoreFloat4x4(&mirror, XMMatrixRotationY(XM_PIDIV2) * XMMatrixRotationZ(XM_PIDIV4) * XMMatrixTranslation(-1.8f, 0.25f, -0.5f));
+	PumaSimulation simulation(mirror);
+	const float dt = 1.f / 120.f;
+	simulation.Step(dt);
+	// obrot podstawy o pelny kat - ta sama poza, ale galaz 0 (katy w [-pi, pi]) jest o 2 pi dalej
+	ManipulatorInput input;
+	input.jointVelocity[0] = XM_2PI / dt;
+	simulation.Step(dt, input);
+	simulation.SetAnimation(true);
+
+	int unreachable = 0, returns = 0;
+	bool reachable = true;
+	for (int step = 2; step <= 600; ++step)
+	{
+		XMFLOAT3 pos, normal;
+		float angles[PumaJointCount];
+		AnimationTarget(mirror, step * dt, pos, normal);
+		bool nowReachable = simulation.Kinematics().InverseKinematics(pos, normal, angles);
+		unreachable += !nowReachable;
+		returns += nowReachable && !reachable;
+		reachable = nowReachable;
+
+		std::vector<float> previous(simulation.Angles(), simulation.Angles() + PumaJointCount);
+		simulation.Step(dt);
+		for (size_t j = 0; j < PumaJointCount; ++j)
+			ASSERT_LT(std::abs(simulation.Angles()[j] - previous[j]), 0.15f) << "step " << step << " joint " << j;
+	}
+	EXPECT_GT(unreachable, 100);
+	EXPECT_GT(returns, 0);
+	EXPECT_GT(simulation.Angles()[0], XM_PI);
+}
+
+TEST(PumaSimulationTest, ManualControlStopsAnimation)
+{
+	PumaSimulation simulation(SceneMirrorMtx());
+	simulation.Step(0.01f);
+	std::vector<float> animated(simulation.Angles(), simulation.Angles() + PumaJointCount);
+	ManipulatorInput input;
+	input.jointVelocity[0] = 1.f;
+	simulation.Step(0.01f, input);
+	EXPECT_FALSE(simulation.Animation());
+	EXPECT_FLOAT_EQ(simulation.Angles()[0], animated[0] + 0.01f);
+	size_t particles = simulation.Particles().particlesCount();
+	simulation.Step(0.01f);
+	EXPECT_FLOAT_EQ(simulation.Angles()[0], animated[0] + 0.01f);
+	EXPECT_EQ(simulation.Particles().particlesCount(), particles);
+}
+
+TEST(PumaSimulationTest, RenderingInterpolatesBetweenSteps)
+{
+	PumaSimulation simulation(SceneMirrorMtx(), 1);
+	for (int i = 0; i < 30; ++i)
+		simulation.Step(1.f / 120.f);
+	float previous[PumaJointCount];
+	std::copy(simulation.Angles(), simulation.Angles() + PumaJointCount, previous);
+	simulation.Step(1.f / 120.f);
+
+	XMFLOAT4X4 links[PumaLinkCount], expected[PumaLinkCount];
+	simulation.LinkMatrices(0.f, links);
+	simulation.Kinematics().LinkMatrices(previous, expected);
+	EXPECT_EQ(std::memcmp(links, expected, sizeof(links)), 0);
+	simulation.LinkMatrices(1.f, links);
+	simulation.Kinematics().LinkMatrices(simulation.Angles(), expected);
+	EXPECT_EQ(std::memcmp(links, expected, sizeof(links)), 0);
+
+	const XMFLOAT4 camera = { 2.f, 1.f, 2.f, 1.f };
+	std::vector<ParticleVertex> last, before;
+	for (const Particle& p : simulation.Particles().particles())
+	{
+		last.push_back(p.Vertex);
+		before.push_back(p.Vertex);
+		before.back().Pos = p.Vertex.PrevPos;
+	}
+	ASSERT_FALSE(last.empty());
+	EXPECT_EQ(Positions(simulation.ParticleVertices(camera, 1.f)), Positions(last));
+	auto start = Positions(simulation.ParticleVertices(camera, 0.f)), expectedStart = Positions(before);
+	ASSERT_EQ(start.size(), expectedStart.size());
+	for (size_t i = 0; i < start.size(); ++i)
+	{
+		EXPECT_NEAR(std::get<0>(start[i]), std::get<0>(expectedStart[i]), 1e-6f);
+		EXPECT_NEAR(std::get<1>(start[i]), std::get<1>(expectedStart[i]), 1e-6f);
+		EXPECT_NEAR(std::get<2>(start[i]), std::get<2>(expectedStart[i]), 1e-6f);
+	}
+}
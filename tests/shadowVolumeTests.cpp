@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include "shadowVolume.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+using mini::test::Cube;
+
+namespace
+{
+	XMFLOAT4X4 Identity()
+	{
+		XMFLOAT4X4 m;
+		XMStoreFloat4x4(&m, XMMatrixIdentity());
+		return m;
+	}
+
+	using Point = std::tuple<float, float, float, float>;
+
+	//Every directed edge of a closed, consistently wound triangle mesh has a matching opposite edge
+	bool IsClosed(const ShadowVolume& volume)
+	{
+		std::map<std::pair<Point, Point>, int> directedEdges;
+		auto point = [&](uint32_t i) { auto& v = volume.vertices[i]; return Point{ v.x, v.y, v.z, v.w }; };
+		for (size_t i = 0; i < volume.indices.size(); i += 3)
+			for (int j = 0; j < 3; ++j)
+				++directedEdges[{ point(volume.indices[i + j]), point(volume.indices[i + (j + 1) % 3]) }];
+		for (const auto& [edge, count] : directedEdges)
+		{
+			auto it = directedEdges.find({ edge.second, edge.first });
+			if (it == directedEdges.end() || it->second != count)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST(ShadowCasterTest, CubeAdjacencyIsManifold)
+{
+	auto cube = Cube();
+	ASSERT_EQ(cube.edges.size(), 18u);
+	for (const auto& edge : cube.edges)
+		EXPECT_NE(edge.face1, UINT_MAX);
+}
+
+TEST(ShadowCasterTest, LightAboveCubeExtrudesTopSilhouette)
+{
+	auto cube = Cube();
+	ShadowVolume volume;
+	cube.GenerateShadowVolume(volume, { 0.0f, 10.0f, 0.0f }, Identity(), 10.0f);
+
+	// 4 silhouette quads (2 triangles each) and both caps (one triangle per face)
+	EXPECT_EQ(volume.indices.size(), 3u * (4 * 2 + 12));
+	// all 8 corners and the 4 top corners extruded, each emitted once
+	EXPECT_EQ(volume.vertices.size(), 8u + 4u);
+	EXPECT_TRUE(IsClosed(volume));
+}
+
+TEST(ShadowCasterTest, FacingIsComputedOncePerFace)
+{
+	auto cube = Cube();
+	ShadowVolume volume;
+	cube.GenerateShadowVolume(volume, { 0.0f, 10.0f, 0.0f }, Identity(), 10.0f);
+
+	// only the two top triangles face the light
+	ASSERT_EQ(volume.facing.size(), cube.faces.size());
+	EXPECT_EQ(volume.facing.count(), 10u);
+	EXPECT_FALSE(volume.facing[10]);
+	EXPECT_FALSE(volume.facing[11]);
+}
+
+TEST(ShadowCasterTest, VolumeIsClosedForArbitraryLightAndTransform)
+{
+	auto cube = Cube();
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixRotationY(0.3f) * XMMatrixRotationZ(0.7f) * XMMatrixTranslation(0.5f, -1.0f, 2.0f));
+	const XMFLOAT3 lights[] = { { 2.0f, 3.0f, 2.0f }, { -4.0f, 0.5f, 1.0f }, { 0.1f, -5.0f, 3.0f } };
+	ShadowVolume volume;
+	for (const auto& light : lights)
+	{
+		cube.GenerateShadowVolume(volume, light, world, 10.0f);
+		EXPECT_FALSE(volume.indices.empty());
+		EXPECT_TRUE(IsClosed(volume));
+	}
+}
+
+TEST(ShadowCasterTest, ExtrudedVerticesLieAtExtrusionDistance)
+{
+	auto cube = Cube();
+	ShadowVolume volume;
+	const XMFLOAT3 light = { 2.0f, 3.0f, 2.0f };
+	const float extrusion = 7.5f;
+	cube.GenerateShadowVolume(volume, light, Identity(), extrusion);
+
+	XMVECTOR l = XMLoadFloat3(&light);
+	int extruded = 0;
+	for (const auto& v : volume.vertices)
+	{
+		EXPECT_EQ(v.w, 1.0f);
+		XMVECTOR p = XMLoadFloat4(&v);
+		float d = XMVectorGetX(XMVector3Length(p - l));
+		if (d > 6.0f)
+		{
+			++extruded;
+			// cube corners are 2.5-5 units from the light
+			EXPECT_GT(d, extrusion + 2.5f);
+			EXPECT_LT(d, extrusion + 5.0f);
+		}
+	}
+	EXPECT_GT(extruded, 0);
+}
+
+TEST(ShadowCasterTest, ObjectSpaceVolumeTransformsToWorldSpaceVolume)
+{
+	auto cube = Cube();
+	XMFLOAT4X4 world;
+	XMMATRIX m = XMMatrixScaling(1.0f, 2.0f, 0.5f) * XMMatrixRotationX(0.4f) * XMMatrixTranslation(1.0f, 0.0f, -2.0f);
+	XMStoreFloat4x4(&world, m);
+	ShadowVolume worldVolume, objectVolume;
+	cube.GenerateShadowVolume(worldVolume, { 2.0f, 3.0f, 2.0f }, world, 10.0f, VolumeSpace::World);
+	cube.GenerateShadowVolume(objectVolume, { 2.0f, 3.0f, 2.0f }, world, 10.0f, VolumeSpace::Object);
+
+	ASSERT_EQ(objectVolume.indices, worldVolume.indices);
+	ASSERT_EQ(objectVolume.vertices.size(), worldVolume.vertices.size());
+	for (size_t i = 0; i < objectVolume.vertices.size(); ++i)
+	{
+		XMVECTOR p = XMVector4Transform(XMLoadFloat4(&objectVolume.vertices[i]), m);
+		EXPECT_TRUE(XMVector4NearEqual(p, XMLoadFloat4(&worldVolume.vertices[i]), XMVectorReplicate(1e-4f)));
+	}
+}
+
+TEST(ShadowCasterTest, LargeVolumeUsesFullIndexRange)
+{
+	// 180000 triangles, the volume has more vertices than 16-bit indices can address
+	auto torus = test::Torus(300, 300);
+	ShadowVolume volume;
+	torus.GenerateShadowVolume(volume, { 2.0f, 3.0f, 2.0f }, Identity(), 10.0f);
+
+	ASSERT_GT(volume.vertices.size(), 65536u);
+	EXPECT_EQ(*std::max_element(volume.indices.begin(), volume.indices.end()), volume.vertices.size() - 1);
+	EXPECT_TRUE(IsClosed(volume));
+}
+
+TEST(ShadowCasterTest, InfiniteExtrusionMatchesFiniteDirections)
+{
+	auto cube = Cube();
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixRotationY(0.3f) * XMMatrixRotationZ(0.7f) * XMMatrixTranslation(0.5f, -1.0f, 2.0f));
+	const XMFLOAT3 light = { 2.0f, 3.0f, 2.0f };
+	ShadowVolume finite, infinite;
+	cube.GenerateShadowVolume(finite, light, world, 10.0f);
+	cube.GenerateShadowVolume(infinite, light, world, InfiniteExtrusion);
+
+	ASSERT_EQ(infinite.indices, finite.indices);
+	ASSERT_EQ(infinite.vertices.size(), finite.vertices.size());
+	EXPECT_TRUE(IsClosed(infinite));
+	XMVECTOR l = XMLoadFloat3(&light);
+	int extruded = 0;
+	for (size_t i = 0; i < finite.vertices.size(); ++i)
+	{
+		XMVECTOR f = XMLoadFloat4(&finite.vertices[i]);
+		XMVECTOR p = XMLoadFloat4(&infinite.vertices[i]);
+		if (infinite.vertices[i].w == 1.0f)
+		{
+			EXPECT_TRUE(XMVector4NearEqual(p, f, XMVectorReplicate(1e-5f)));
+			continue;
+		}
+		// point at infinity in the direction the finite vertex was pushed away from the light
+		++extruded;
+		EXPECT_EQ(infinite.vertices[i].w, 0.0f);
+		EXPECT_TRUE(XMVector3NearEqual(XMVector3Normalize(p), XMVector3Normalize(f - l), XMVectorReplicate(1e-4f)));
+	}
+	EXPECT_GT(extruded, 0);
+}
+
+TEST(ShadowCasterTest, VerticesWithSplitNormalsShareVolumeVertices)
+{
+	auto cube = Cube();
+	// every face gets its own copies of its vertices, as with per-face normals
+	auto split = cube;
+	split.vertices.clear();
+	for (auto& face : split.faces)
+		for (auto& index : face.indices)
+		{
+			split.vertices.push_back(cube.vertices[index]);
+			index = static_cast<unsigned>(split.vertices.size() - 1);
+		}
+	split.PrepareSilhouetteData();
+
+	ShadowVolume shared, expected;
+	split.GenerateShadowVolume(shared, { 2.0f, 3.0f, 2.0f }, Identity(), 10.0f);
+	cube.GenerateShadowVolume(expected, { 2.0f, 3.0f, 2.0f }, Identity(), 10.0f);
+	EXPECT_EQ(shared.indices, expected.indices);
+	EXPECT_EQ(shared.vertices.size(), expected.vertices.size());
+	EXPECT_LE(shared.vertices.size(), 2 * cube.positions.size());
+	EXPECT_TRUE(IsClosed(shared));
+}
+
+TEST(ShadowCasterTest, VertexWithoutPositionIsRejected)
+{
+	auto cube = Cube();
+	cube.vertices.push_back({ 5.0f, 5.0f, 5.0f });
+	EXPECT_THROW(cube.PrepareSilhouetteData(), std::invalid_argument);
+}
+
+TEST(ShadowCasterTest, OpenMeshCastsClosedVolume)
+{
+	// kwadrat z wierzcholkami rozdzielonymi przez normalne (jak DoubleRect bez tylnej strony)
+	ShadowCaster quad;
+	quad.vertices = {
+		{ 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+	};
+	quad.faces = { Face(0, 1, 2), Face(3, 4, 5) };
+	AdjacencyStats stats = quad.BuildAdjacency();
+	EXPECT_EQ(quad.positions.size(), 4u);
+	EXPECT_EQ(stats.boundaryEdges, 4u);
+	EXPECT_EQ(stats.closingFaces, 2u);
+	EXPECT_EQ(quad.faces.size(), 4u);
+
+	for (XMFLOAT3 light : { XMFLOAT3(0.3f, 0.4f, 2.0f), XMFLOAT3(0.3f, 0.4f, -2.0f), XMFLOAT3(3.0f, 0.5f, 0.1f) })
+	{
+		ShadowVolume volume;
+		quad.GenerateShadowVolume(volume, light, Identity(), 10.0f);
+		EXPECT_FALSE(volume.indices.empty());
+		EXPECT_TRUE(IsClosed(volume));
+	}
+}
+
+TEST(ShadowCasterTest, PrepareMeshBuildsMeshletsOfClosedMeshesOnly)
+{
+	// zamknieta siatka bez krawedzi - sasiedztwo odtworzone, meshlety
+	auto torus = test::Torus(24, 12);
+	torus.edges.clear();
+	EXPECT_TRUE(torus.PrepareMesh());
+	EXPECT_EQ(torus.faces.size(), 2u * 24 * 12);
+	EXPECT_FALSE(torus.edges.empty());
+	EXPECT_FALSE(torus.Meshlets().empty());
+
+	// krawedzie z pliku z otwartym brzegiem - sciany zamykajace, bez meshletow
+	ShadowCaster quad;
+	quad.positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+	quad.vertices = quad.positions;
+	quad.faces = { Face(0, 1, 2), Face(0, 2, 3) };
+	quad.edges = BuildEdges(quad.faces, { 0, 1, 2, 3 });
+	EXPECT_FALSE(quad.PrepareMesh());
+	EXPECT_EQ(quad.faces.size(), 4u);
+	EXPECT_TRUE(quad.Meshlets().empty());
+	ShadowVolume volume;
+	quad.GenerateShadowVolume(volume, { 0.3f, 0.4f, 2.0f }, Identity(), 10.0f);
+	EXPECT_TRUE(IsClosed(volume));
+}
+
+TEST(ShadowCasterTest, OpenEdgeIsRejected)
+{
+	auto cube = Cube();
+	cube.edges.back().face1 = UINT_MAX;
+	EXPECT_THROW(cube.PrepareSilhouetteData(), std::invalid_argument);
+}
+
+TEST(ShadowCasterTest, TemporalCoherenceMatchesFullRebuild)
+{
+	auto torus = test::Torus(40, 30);
+	ShadowVolume coherent, expected;
+	coherent.temporalCoherence = true;
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, XMMatrixRotationY(0.02f * frame) * XMMatrixTranslation(0.0f, 0.5f, 0.0f));
+		torus.GenerateShadowVolume(coherent, { 2.0f, 3.0f, 2.0f }, world, 10.0f);
+		torus.GenerateShadowVolume(expected, { 2.0f, 3.0f, 2.0f }, world, 10.0f);
+		ASSERT_EQ(coherent.indices.size(), expected.indices.size());
+		ASSERT_EQ(coherent.vertices.size(), expected.vertices.size());
+		EXPECT_TRUE(IsClosed(coherent));
+	}
+	EXPECT_FALSE(coherent.tracker.FullScan());
+	EXPECT_LT(coherent.tracker.TestedFraction(), 1.0f);
+}
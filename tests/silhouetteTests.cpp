@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "silhouette.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	std::vector<SimdLevel> SupportedLevels()
+	{
+		std::vector<SimdLevel> levels{ SimdLevel::Scalar };
+		if (DetectSimdLevel() >= SimdLevel::SSE4)
+			levels.push_back(SimdLevel::SSE4);
+		if (DetectSimdLevel() >= SimdLevel::AVX2)
+			levels.push_back(SimdLevel::AVX2);
+		return levels;
+	}
+
+	//Reference silhouette: per edge facing test, as done before the kernels existed
+	std::vector<uint32_t> BruteForceSilhouette(const ShadowCaster& caster, XMFLOAT3 light)
+	{
+		auto facing = [&](unsigned f)
+		{
+			const Face& face = caster.faces[f];
+			XMVECTOR p0 = XMLoadFloat3(&caster.vertices[face.indices[0]]);
+			XMVECTOR p1 = XMLoadFloat3(&caster.vertices[face.indices[1]]);
+			XMVECTOR p2 = XMLoadFloat3(&caster.vertices[face.indices[2]]);
+			XMVECTOR n = XMVector3Cross(p1 - p0, p2 - p0);
+			return XMVectorGetX(XMVector3Dot(n, p0 - XMLoadFloat3(&light))) > 0.f;
+		};
+		std::vector<uint32_t> result;
+		for (uint32_t i = 0; i < caster.edges.size(); ++i)
+		{
+			const Edge& e = caster.edges[i];
+			if (e.face1 != UINT_MAX && facing(e.face0) != facing(e.face1))
+				result.push_back(i);
+		}
+		return result;
+	}
+}
+
+TEST(SilhouetteTest, KernelsMatchBruteForce)
+{
+	// 1000 faces: not a multiple of the block size, exercises padding
+	auto torus = test::Torus(20, 25);
+	FacePlanes planes;
+	EdgeFaces edgeFaces;
+	planes.Build(torus.vertices, torus.faces);
+	edgeFaces.Build(torus.edges);
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> coord(-4.0f, 4.0f);
+	for (int i = 0; i < 20; ++i)
+	{
+		XMFLOAT3 light{ coord(rng), coord(rng), coord(rng) };
+		auto expected = BruteForceSilhouette(torus, light);
+		for (SimdLevel level : SupportedLevels())
+		{
+			FaceBitset facing;
+			std::vector<uint32_t> silhouette;
+			ClassifyFaces(planes, light, false, facing, level);
+			GatherSilhouetteEdges(edgeFaces, facing, silhouette, level);
+			ASSERT_EQ(facing.size(), torus.faces.size());
+			EXPECT_EQ(silhouette, expected) << "level " << static_cast<int>(level);
+		}
+	}
+}
+
+TEST(SilhouetteTest, FlipInvertsEveryFace)
+{
+	auto cube = test::Cube();
+	FacePlanes planes;
+	planes.Build(cube.vertices, cube.faces);
+	for (SimdLevel level : SupportedLevels())
+	{
+		FaceBitset facing, flipped;
+		ClassifyFaces(planes, { 0.0f, 10.0f, 0.0f }, false, facing, level);
+		ClassifyFaces(planes, { 0.0f, 10.0f, 0.0f }, true, flipped, level);
+		for (size_t i = 0; i < cube.faces.size(); ++i)
+			EXPECT_NE(facing[i], flipped[i]);
+		// padding must stay clear
+		EXPECT_EQ(facing.count() + flipped.count(), cube.faces.size());
+	}
+}
+
+TEST(SilhouetteTest, RangesMatchFullScan)
+{
+	auto torus = test::Torus(20, 25);
+	FacePlanes planes;
+	EdgeFaces edgeFaces;
+	planes.Build(torus.vertices, torus.faces);
+	edgeFaces.Build(torus.edges);
+	const XMFLOAT3 light{ 1.5f, 2.0f, -0.5f };
+	// unaligned ranges, ranges inside one block and ranges ending at the last face
+	const size_t bounds[] = { 0, 3, 5, 8, 45, 64, 101, 997, 999, 1000 };
+	for (SimdLevel level : SupportedLevels())
+	{
+		FaceBitset expected, facing;
+		std::vector<uint32_t> expectedEdges, silhouette;
+		ClassifyFaces(planes, light, true, expected, level);
+		GatherSilhouetteEdges(edgeFaces, expected, expectedEdges, level);
+		facing.reset(planes.count);
+		for (size_t i = 0; i + 1 < std::size(bounds); ++i)
+			ClassifyFaces(planes, light, true, bounds[i], bounds[i + 1] - bounds[i], facing, level);
+		for (size_t i = 0; i < planes.count; ++i)
+			ASSERT_EQ(facing[i], expected[i]) << "face " << i << ", level " << static_cast<int>(level);
+		EXPECT_EQ(facing.count(), expected.count());
+
+		const size_t edgeBounds[] = { 0, 7, 9, 1024, 1030, 1500 };
+		for (size_t i = 0; i + 1 < std::size(edgeBounds); ++i)
+			GatherSilhouetteEdges(edgeFaces, facing, edgeBounds[i], edgeBounds[i + 1] - edgeBounds[i], silhouette, level);
+		EXPECT_EQ(silhouette, expectedEdges) << "level " << static_cast<int>(level);
+	}
+
+	FaceBitset bits;
+	bits.reset(100);
+	bits.set(30, 40);
+	EXPECT_EQ(bits.count(), 40u);
+	EXPECT_FALSE(bits[29]);
+	EXPECT_TRUE(bits[30]);
+	EXPECT_TRUE(bits[69]);
+	EXPECT_FALSE(bits[70]);
+}
+
+TEST(SilhouetteTest, OpenEdgesAreNeverSilhouette)
+{
+	std::vector<Edge> edges{ { 0, 1, 0, UINT_MAX }, { 1, 2, 0, 1 } };
+	EdgeFaces edgeFaces;
+	edgeFaces.Build(edges);
+	FaceBitset facing;
+	facing.reset(2);
+	facing.set(0);
+	for (SimdLevel level : SupportedLevels())
+	{
+		std::vector<uint32_t> silhouette;
+		GatherSilhouetteEdges(edgeFaces, facing, silhouette, level);
+		EXPECT_EQ(silhouette, std::vector<uint32_t>{ 1u });
+	}
+}
+
+namespace
+{
+	std::vector<uint32_t> Sorted(std::vector<uint32_t> v)
+	{
+		std::sort(v.begin(), v.end());
+		return v;
+	}
+}
+
+TEST(SilhouetteTrackerTest, FollowsMovingLight)
+{
+	auto torus = test::Torus(60, 40);
+	FacePlanes planes;
+	EdgeFaces edgeFaces;
+	FaceEdges faceEdges;
+	planes.Build(torus.vertices, torus.faces);
+	edgeFaces.Build(torus.edges);
+	faceEdges.Build(torus.edges, torus.faces.size());
+
+	SilhouetteTracker tracker;
+	FaceBitset facing, expectedFacing;
+	std::vector<uint32_t> silhouette, expected;
+	XMVECTOR scanDir = XMVectorZero();
+	int incremental = 0;
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		float t = 0.01f * frame;
+		XMFLOAT3 light{ 3.0f * std::cos(t), 2.0f + std::sin(3.0f * t), 3.0f * std::sin(t) };
+		tracker.Update(planes, edgeFaces, faceEdges, light, { 0.0f, 0.0f, 0.0f }, false, facing, silhouette);
+		ClassifyFaces(planes, light, false, expectedFacing);
+		GatherSilhouetteEdges(edgeFaces, expectedFacing, expected);
+
+		ASSERT_EQ(Sorted(silhouette), expected) << "frame " << frame;
+		for (size_t f = 0; f < torus.faces.size(); ++f)
+			ASSERT_EQ(facing[f], expectedFacing[f]);
+		// full scans only when the light has rotated past the threshold since the last one
+		XMVECTOR dir = XMVector3Normalize(XMLoadFloat3(&light));
+		float angle = std::acos(std::min(1.0f, XMVectorGetX(XMVector3Dot(dir, scanDir))));
+		if (frame > 0 && std::abs(angle - tracker.rotationThreshold) > 1e-4f)
+		{
+			EXPECT_EQ(tracker.FullScan(), angle > tracker.rotationThreshold) << "frame " << frame;
+		}
+		if (tracker.FullScan())
+			scanDir = dir;
+		else
+		{
+			++incremental;
+			EXPECT_LT(tracker.TestedFraction(), 0.5f);
+		}
+	}
+	EXPECT_GT(incremental, 80);
+}
+
+TEST(SilhouetteTrackerTest, SlowRotationAddsUpToFullScan)
+{
+	auto cube = test::Cube();
+	FacePlanes planes;
+	EdgeFaces edgeFaces;
+	FaceEdges faceEdges;
+	planes.Build(cube.vertices, cube.faces);
+	edgeFaces.Build(cube.edges);
+	faceEdges.Build(cube.edges, cube.faces.size());
+
+	SilhouetteTracker tracker;
+	FaceBitset facing;
+	std::vector<uint32_t> silhouette;
+	// every step far below the threshold, their sum above it
+	const float step = 0.2f * tracker.rotationThreshold;
+	for (int i = 0; i <= 5; ++i)
+	{
+		float angle = 0.3f + step * i;
+		tracker.Update(planes, edgeFaces, faceEdges, { 10.0f * std::cos(angle), 4.0f, 10.0f * std::sin(angle) }, {},
+			false, facing, silhouette);
+		EXPECT_EQ(tracker.FullScan(), i == 0) << "step " << i;
+	}
+	tracker.Update(planes, edgeFaces, faceEdges, { 10.0f * std::cos(0.3f + 6 * step), 4.0f, 10.0f * std::sin(0.3f + 6 * step) },
+		{}, false, facing, silhouette);
+	EXPECT_TRUE(tracker.FullScan());
+}
+
+TEST(SilhouetteTrackerTest, FallsBackToFullScan)
+{
+	auto cube = test::Cube();
+	FacePlanes planes;
+	EdgeFaces edgeFaces;
+	FaceEdges faceEdges;
+	planes.Build(cube.vertices, cube.faces);
+	edgeFaces.Build(cube.edges);
+	faceEdges.Build(cube.edges, cube.faces.size());
+
+	SilhouetteTracker tracker;
+	FaceBitset facing;
+	std::vector<uint32_t> silhouette;
+	tracker.Update(planes, edgeFaces, faceEdges, { 0.0f, 10.0f, 0.0f }, {}, false, facing, silhouette);
+	EXPECT_TRUE(tracker.FullScan());
+	EXPECT_EQ(tracker.EdgesTested(), cube.edges.size());
+
+	tracker.Update(planes, edgeFaces, faceEdges, { 0.1f, 10.0f, 0.0f }, {}, false, facing, silhouette);
+	EXPECT_FALSE(tracker.FullScan());
+	// rotation above the threshold
+	tracker.Update(planes, edgeFaces, faceEdges, { 10.0f, 0.1f, 0.0f }, {}, false, facing, silhouette);
+	EXPECT_TRUE(tracker.FullScan());
+	// mirrored transform
+	tracker.Update(planes, edgeFaces, faceEdges, { 10.0f, 0.1f, 0.0f }, {}, true, facing, silhouette);
+	EXPECT_TRUE(tracker.FullScan());
+	tracker.Reset();
+	tracker.Update(planes, edgeFaces, faceEdges, { 10.0f, 0.1f, 0.0f }, {}, true, facing, silhouette);
+	EXPECT_TRUE(tracker.FullScan());
+}
+
+TEST(SilhouetteTrackerTest, FaceEdgesListEveryAdjacentEdge)
+{
+	auto cube = test::Cube();
+	FaceEdges faceEdges;
+	faceEdges.Build(cube.edges, cube.faces.size());
+	ASSERT_EQ(faceEdges.start.size(), cube.faces.size() + 1);
+	for (uint32_t f = 0; f < cube.faces.size(); ++f)
+	{
+		ASSERT_EQ(faceEdges.start[f + 1] - faceEdges.start[f], 3u);
+		for (uint32_t i = faceEdges.start[f]; i < faceEdges.start[f + 1]; ++i)
+		{
+			const Edge& e = cube.edges[faceEdges.edges[i]];
+			EXPECT_TRUE(e.face0 == f || e.face1 == f);
+		}
+	}
+}
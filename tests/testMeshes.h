@@ -0,0 +1,61 @@
+#pragma once
+#include <cmath>
+#include "shadowVolume.h"
+
+//Closed, consistently wound meshes used by tests and benchmarks
+namespace mini::test
+{
+	//Unit cube centered at the origin. Positions and vertices are the same
+	//(no split normals).
+	inline ShadowCaster Cube()
+	{
+		ShadowCaster cube;
+		cube.positions = {
+			{ -0.5f, -0.5f, -0.5f }, { +0.5f, -0.5f, -0.5f }, { +0.5f, +0.5f, -0.5f }, { -0.5f, +0.5f, -0.5f },
+			{ -0.5f, -0.5f, +0.5f }, { +0.5f, -0.5f, +0.5f }, { +0.5f, +0.5f, +0.5f }, { -0.5f, +0.5f, +0.5f },
+		};
+		cube.vertices = cube.positions;
+		const unsigned short idx[] = {
+			0, 3, 2, 0, 2, 1, // -z
+			4, 5, 6, 4, 6, 7, // +z
+			0, 4, 7, 0, 7, 3, // -x
+			1, 2, 6, 1, 6, 5, // +x
+			0, 1, 5, 0, 5, 4, // -y
+			3, 7, 6, 3, 6, 2, // +y
+		};
+		for (unsigned short f = 0; f < 12; ++f)
+			cube.faces.emplace_back(idx[3 * f], idx[3 * f + 1], idx[3 * f + 2]);
+		cube.BuildAdjacency();
+		return cube;
+	}
+
+	//Torus in the xz plane with 2 * rings * sides triangles
+	inline ShadowCaster Torus(unsigned rings, unsigned sides, float radius = 1.0f, float tube = 0.3f)
+	{
+		ShadowCaster torus;
+		torus.positions.reserve(rings * sides);
+		for (unsigned i = 0; i < rings; ++i)
+		{
+			float u = 6.2831853f * i / rings;
+			for (unsigned j = 0; j < sides; ++j)
+			{
+				float v = 6.2831853f * j / sides;
+				float r = radius + tube * std::cos(v);
+				torus.positions.emplace_back(r * std::cos(u), tube * std::sin(v), r * std::sin(u));
+			}
+		}
+		torus.vertices = torus.positions;
+
+		torus.faces.reserve(2 * rings * sides);
+		for (unsigned i = 0; i < rings; ++i)
+			for (unsigned j = 0; j < sides; ++j)
+			{
+				unsigned a = i * sides + j, b = i * sides + (j + 1) % sides;
+				unsigned c = (i + 1) % rings * sides + j, d = (i + 1) % rings * sides + (j + 1) % sides;
+				torus.faces.emplace_back(a, b, d);
+				torus.faces.emplace_back(a, d, c);
+			}
+		torus.BuildAdjacency();
+		return torus;
+	}
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <charconv>
+#include <random>
+#include <string>
+#include "textParser.h"
+
+using namespace mini;
+
+namespace
+{
+	TextParser Parser(const std::string& text)
+	{
+		return TextParser(text.data(), text.data() + text.size(), "test");
+	}
+}
+
+TEST(TextParserTest, ReadsNumbersAcrossLines)
+{
+	std::string text = "3\r\n-0.5 1e-3\t42\n  7";
+	auto parser = Parser(text);
+	EXPECT_EQ(parser.ReadCount(1), 3u);
+	EXPECT_EQ(parser.ReadFloat(), -0.5f);
+	EXPECT_EQ(parser.ReadFloat(), 1e-3f);
+	EXPECT_EQ(parser.ReadUnsigned(), 42u);
+	EXPECT_EQ(parser.ReadUnsigned(), 7u);
+	EXPECT_NO_THROW(parser.ExpectEnd());
+}
+
+TEST(TextParserTest, ReportsLineAndColumnOfBadToken)
+{
+	std::string text = "1 2\n3 4.5 6\n";
+	auto parser = Parser(text);
+	parser.ReadUnsigned();
+	parser.ReadUnsigned();
+	parser.ReadUnsigned();
+	try
+	{
+		parser.ReadUnsigned();
+		FAIL() << "4.5 is not an unsigned integer";
+	}
+	catch (const TextParseError& e)
+	{
+		EXPECT_EQ(e.line(), 2u);
+		EXPECT_EQ(e.column(), 3u);
+		EXPECT_EQ(std::string(e.what()).rfind("test:2:3: ", 0), 0u);
+	}
+}
+
+TEST(TextParserTest, ReportsEndOfFileAndTrailingData)
+{
+	std::string text = "1\n2 x";
+	auto parser = Parser(text);
+	parser.ReadFloat();
+	parser.ReadFloat();
+	try
+	{
+		parser.ExpectEnd();
+		FAIL();
+	}
+	catch (const TextParseError& e)
+	{
+		EXPECT_EQ(e.line(), 2u);
+		EXPECT_EQ(e.column(), 3u);
+	}
+
+	std::string truncated = "1 2\n";
+	auto short_ = Parser(truncated);
+	short_.ReadFloat();
+	short_.ReadFloat();
+	try
+	{
+		short_.ReadFloat();
+		FAIL();
+	}
+	catch (const TextParseError& e)
+	{
+		EXPECT_EQ(e.line(), 2u);
+		EXPECT_EQ(e.column(), 1u);
+	}
+}
+
+TEST(TextParserTest, RejectsCountsLargerThanTheFile)
+{
+	std::string text = "4000000000\n1 2 3";
+	auto parser = Parser(text);
+	try
+	{
+		parser.ReadCount(3);
+		FAIL();
+	}
+	catch (const TextParseError& e)
+	{
+		EXPECT_EQ(e.line(), 1u);
+		EXPECT_EQ(e.column(), 1u);
+	}
+	std::string negative = "-1";
+	EXPECT_THROW(Parser(negative).ReadUnsigned(), TextParseError);
+}
+
+TEST(TextParserTest, ShortDecimalsMatchFromChars)
+{
+	std::mt19937 rng(7);
+	std::string text;
+	for (int i = 0; i < 20000; ++i)
+	{
+		int digits = 1 + rng() % 7, fraction = rng() % (digits + 1);
+		std::string token = rng() % 2 ? "-" : "";
+		for (int d = 0; d < digits; ++d)
+		{
+			if (d == digits - fraction)
+				token += d ? "." : "0.";
+			token += static_cast<char>('0' + rng() % 10);
+		}
+		text += token + (i % 8 == 7 ? "\n" : " ");
+	}
+	// dluzsze zapisy i wykladniki ida przez from_chars
+	text += "0.300000012 1e-5 123456789.5";
+
+	auto parser = Parser(text);
+	const char* p = text.data();
+	const char* end = text.data() + text.size();
+	while (p != end)
+	{
+		float expected;
+		auto result = std::from_chars(p, end, expected);
+		ASSERT_EQ(result.ec, std::errc());
+		ASSERT_EQ(parser.ReadFloat(), expected) << std::string(p, result.ptr);
+		p = result.ptr == end ? end : result.ptr + 1;
+	}
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "vertexCache.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	//Triangle list of a rows x columns grid of quads
+	std::vector<uint32_t> Grid(uint32_t rows, uint32_t columns)
+	{
+		std::vector<uint32_t> indices;
+		for (uint32_t i = 0; i < rows; ++i)
+			for (uint32_t j = 0; j < columns; ++j)
+			{
+				uint32_t a = i * (columns + 1) + j, b = a + 1, c = a + columns + 1, d = c + 1;
+				indices.insert(indices.end(), { a, b, d, a, d, c });
+			}
+		return indices;
+	}
+
+	void ShuffleTriangles(std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+		std::copy(indices.begin(), indices.end(), triangles[0].data());
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+		std::copy(triangles[0].data(), triangles[0].data() + indices.size(), indices.begin());
+	}
+
+	//Triangles as sorted rotations, independent of the triangle order
+	std::vector<std::array<uint32_t, 3>> Triangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			std::array<uint32_t, 3> t{ indices[i], indices[i + 1], indices[i + 2] };
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			triangles.push_back(t);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+}
+
+TEST(VertexCacheTest, SimulatorCountsFifoMisses)
+{
+	EXPECT_FLOAT_EQ(SimulateAcmr({ 0, 1, 2 }, 3), 3.0f);
+	EXPECT_FLOAT_EQ(SimulateAcmr({ 0, 1, 2, 0, 2, 3 }, 4), 2.0f);
+	// 0 wypada z kolejki o trzech miejscach po wczytaniu 3
+	EXPECT_FLOAT_EQ(SimulateAcmr({ 0, 1, 2, 1, 2, 3, 0, 2, 3 }, 4, 3), 5.0f / 3.0f);
+	EXPECT_FLOAT_EQ(SimulateAcmr({ 0, 1, 2, 1, 2, 3, 0, 2, 3 }, 4, 4), 4.0f / 3.0f);
+}
+
+TEST(VertexCacheTest, OptimizationKeepsTrianglesAndLowersAcmr)
+{
+	auto indices = Grid(60, 60);
+	ShuffleTriangles(indices);
+	const size_t vertexCount = 61 * 61;
+	auto original = indices;
+	float before = SimulateAcmr(indices, vertexCount);
+
+	auto order = OptimizeVertexCache(indices, vertexCount);
+	EXPECT_EQ(Triangles(indices), Triangles(original));
+	for (size_t t = 0; t < order.size(); ++t)
+		EXPECT_TRUE(std::equal(indices.begin() + 3 * t, indices.begin() + 3 * t + 3, original.begin() + 3 * order[t]));
+	float after = SimulateAcmr(indices, vertexCount);
+	EXPECT_GT(before, 2.5f);
+	EXPECT_LT(after, 0.8f);
+	EXPECT_LT(after, SimulateAcmr(Grid(60, 60), vertexCount));
+}
+
+TEST(VertexCacheTest, FetchOrderFollowsFirstUse)
+{
+	std::vector<uint32_t> indices = { 4, 2, 0, 0, 2, 5 };
+	std::vector<int> vertices = { 0, 1, 2, 3, 4, 5 };
+	auto original = indices;
+	auto remap = OptimizeVertexFetch(indices, vertices.size());
+	RemapVertices(vertices, remap);
+	EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3 }));
+	for (size_t i = 0; i < indices.size(); ++i)
+		EXPECT_EQ(vertices[indices[i]], static_cast<int>(original[i]));
+	// nieuzywane wierzcholki na koncu
+	EXPECT_EQ(vertices, (std::vector<int>{ 4, 2, 0, 5, 1, 3 }));
+}
+
+TEST(VertexCacheTest, DegenerateTrianglesAreKept)
+{
+	std::vector<uint32_t> indices = { 0, 1, 2, 2, 2, 3, 1, 3, 2, 4, 4, 4 };
+	auto original = indices;
+	OptimizeVertexCache(indices, 5);
+	EXPECT_EQ(Triangles(indices), Triangles(original));
+}
+
+TEST(VertexCacheTest, MeshFilesKeepGeometryAndAdjacency)
+{
+	for (int i = 1; i <= 6; ++i)
+	{
+		MeshData mesh = LoadBinaryMesh(std::filesystem::path(PUMA_MESH_DIR) / ("mesh" + std::to_string(i) + BinaryMeshExtension));
+		MeshData optimized = mesh;
+		OptimizeVertexOrder(optimized);
+		ASSERT_EQ(optimized.faces.size(), mesh.faces.size());
+		ASSERT_EQ(optimized.edges.size(), mesh.edges.size());
+
+		auto indices = [](const MeshData& m)
+		{
+			std::vector<uint32_t> result;
+			for (const Face& f : m.faces)
+				result.insert(result.end(), std::begin(f.indices), std::end(f.indices));
+			return result;
+		};
+		EXPECT_LE(SimulateAcmr(indices(optimized), optimized.normals.size()), SimulateAcmr(indices(mesh), mesh.normals.size()));
+
+		// pozycje trojkatow i normalne wierzcholkow bez zmian, krawedzie wskazuja sciany z tymi pozycjami
+		auto facePositions = [](const MeshData& m, const Face& f)
+		{
+			std::array<uint32_t, 3> p;
+			for (int j = 0; j < 3; ++j)
+				p[j] = m.vertexPositions[f.indices[j]];
+			return p;
+		};
+		for (size_t e = 0; e < mesh.edges.size(); ++e)
+		{
+			EXPECT_EQ(facePositions(optimized, optimized.faces[optimized.edges[e].face0]), facePositions(mesh, mesh.faces[mesh.edges[e].face0]));
+			EXPECT_EQ(facePositions(optimized, optimized.faces[optimized.edges[e].face1]), facePositions(mesh, mesh.faces[mesh.edges[e].face1]));
+		}
+		std::vector<std::array<float, 6>> before, after;
+		auto corners = [](const MeshData& m, std::vector<std::array<float, 6>>& out)
+		{
+			for (const Face& f : m.faces)
+				for (uint32_t v : f.indices)
+				{
+					const XMFLOAT3& p = m.positions[m.vertexPositions[v]];
+					out.push_back({ p.x, p.y, p.z, m.normals[v].x, m.normals[v].y, m.normals[v].z });
+				}
+			std::sort(out.begin(), out.end());
+		};
+		corners(mesh, before);
+		corners(optimized, after);
+		EXPECT_EQ(before, after);
+	}
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "vertexQuantization.h"
+#include "testMeshes.h"
+
+using namespace mini;
+using namespace DirectX;
+
+namespace
+{
+	//Angle between directions in double precision (float acos is too coarse near 0)
+	float Angle(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		double cx = double(a.y) * b.z - double(a.z) * b.y, cy = double(a.z) * b.x - double(a.x) * b.z;
+		double cz = double(a.x) * b.y - double(a.y) * b.x;
+		double dot = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z;
+		return static_cast<float>(std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot));
+	}
+
+	std::vector<XMFLOAT3> RandomDirections(size_t count)
+	{
+		std::mt19937 rng(11);
+		std::normal_distribution<float> gauss;
+		std::vector<XMFLOAT3> directions(count);
+		for (auto& d : directions)
+			XMStoreFloat3(&d, XMVector3Normalize(XMVectorSet(gauss(rng), gauss(rng), gauss(rng), 0.f)));
+		return directions;
+	}
+}
+
+TEST(VertexQuantizationTest, NormalsStayWithinErrorBound)
+{
+	auto directions = RandomDirections(200000);
+	// osie, przekatne i okolice rownika osmioscianu (z = 0)
+	for (float x : { -1.f, -0.7f, 0.f, 0.3f, 1.f })
+		for (float y : { -1.f, 0.f, 0.5f, 1.f })
+			for (float z : { -1.f, -1e-6f, 0.f, 1e-6f, 1.f })
+				if (x != 0.f || y != 0.f || z != 0.f)
+					directions.emplace_back(x, y, z);
+	float maxError = 0.f;
+	for (const auto& n : directions)
+	{
+		int16_t encoded[2];
+		EncodeOctahedral(n, encoded);
+		maxError = std::max(maxError, Angle(n, DecodeOctahedral(encoded)));
+	}
+	EXPECT_LE(maxError, MaxNormalAngleError);
+	// granica nie jest zawyzona
+	EXPECT_GT(maxError, 0.25f * MaxNormalAngleError);
+}
+
+TEST(VertexQuantizationTest, PositionsStayWithinErrorBound)
+{
+	auto torus = test::Torus(120, 80, 3.5f, 0.4f);
+	for (auto& p : torus.positions)
+		p.y += 20.f;
+	VertexDecode decode = QuantizationBox(torus.positions);
+	EXPECT_TRUE(decode.Quantized());
+	EXPECT_FLOAT_EQ(decode.positionOffset.y, 19.6f);
+	float bound = MaxPositionError(decode);
+	EXPECT_LT(bound, 1e-4f);
+
+	float maxError = 0.f;
+	for (const auto& p : torus.positions)
+	{
+		XMFLOAT3 position, normal;
+		DecodeVertex(EncodeVertex(p, { 0.f, 1.f, 0.f }, decode), decode, position, normal);
+		maxError = std::max({ maxError, std::fabs(position.x - p.x), std::fabs(position.y - p.y), std::fabs(position.z - p.z) });
+		EXPECT_EQ(normal.y, 1.f);
+	}
+	EXPECT_LE(maxError, bound);
+}
+
+TEST(VertexQuantizationTest, FlatAndEmptyBoxes)
+{
+	// plaski prostokat - zerowa grubosc boksu
+	std::vector<XMFLOAT3> positions = { { -1.f, 0.f, 2.f }, { 1.f, 0.f, 2.f }, { 1.f, 3.f, 2.f } };
+	VertexDecode decode = QuantizationBox(positions);
+	EXPECT_EQ(decode.positionScale.z, 0.f);
+	for (const auto& p : positions)
+	{
+		XMFLOAT3 position, normal;
+		DecodeVertex(EncodeVertex(p, { 0.f, 0.f, -1.f }, decode), decode, position, normal);
+		EXPECT_EQ(position.x, p.x);
+		EXPECT_EQ(position.y, p.y);
+		EXPECT_EQ(position.z, p.z);
+		EXPECT_EQ(normal.z, -1.f);
+	}
+	EXPECT_FALSE(VertexDecode().Quantized());
+	EXPECT_EQ(QuantizationBox({}).positionScale.x, 0.f);
+
+	int16_t encoded[2];
+	EncodeOctahedral({ 0.f, 0.f, 0.f }, encoded);
+	EXPECT_EQ(DecodeOctahedral(encoded).z, 1.f);
+}
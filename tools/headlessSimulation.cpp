@@ -0,0 +1,247 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "jobSystem.h"
+#include "meshFile.h"
+#include "pumaSimulation.h"
+#include "shadowVolume.h"
+#include "vertexCache.h"
+
+//Runs the simulation of the Puma scene without a window, input devices or Direct3D:
+//puma_headless [--steps N] [--step SECONDS] [--seed N] [--shadows] [--meshes DIR] [--csv FILE] [--binary FILE]
+//The arm follows the animation, the particles are emitted from its tool and, with --shadows, shadow volumes
+//of the six arm links are generated on the CPU every step from casters loaded and prepared as by the application
+//(vertex order optimized, meshlets), at full detail (no levels of detail without a camera) and with temporal
+//coherence; the cylinder and the mirror are not included. Per step values are written as CSV and/or binary:
+//"PSIM", uint32 version, uint32 column count, then a row of doubles per step, columns as in the CSV header.
+//Reports steps per second.
+
+using namespace mini;
+using namespace gk2;
+using namespace DirectX;
+using namespace std;
+
+namespace
+{
+	//Puma::LIGHT_POS
+	const XMFLOAT3 LightPos = { 2.0f, 3.0f, 2.0f };
+
+	//dlsSolves and dlsIterations count the damped least squares fallbacks of the step only,
+	//the analytic inverse kinematics solved the other steps
+	const char* const Columns[] = { "step", "time", "a0", "a1", "a2", "a3", "a4", "particles", "dlsSolves",
+		"dlsIterations", "shadowTriangles", "silhouetteEdges", "edgesTested" };
+	constexpr size_t ColumnCount = size(Columns);
+
+	struct Options
+	{
+		uint64_t steps = 1200;
+		double step = FixedStepClock::DefaultStep;
+		unsigned int seed = 0;
+		bool shadows = false;
+		filesystem::path meshes = PUMA_MESH_DIR;
+		filesystem::path csv, binary;
+	};
+
+	Options ParseOptions(int argc, char* argv[])
+	{
+		Options options;
+		for (int i = 1; i < argc; ++i)
+		{
+			string arg = argv[i];
+			if (arg == "--shadows")
+			{
+				options.shadows = true;
+				continue;
+			}
+			if (i + 1 == argc)
+				throw invalid_argument("missing value of " + arg);
+			const char* value = argv[++i];
+			if (arg == "--steps")
+				options.steps = stoull(value);
+			else if (arg == "--step")
+				options.step = stod(value);
+			else if (arg == "--seed")
+				options.seed = static_cast<unsigned int>(stoul(value));
+			else if (arg == "--meshes")
+				options.meshes = value;
+			else if (arg == "--csv")
+				options.csv = value;
+			else if (arg == "--binary")
+				options.binary = value;
+			else
+				throw invalid_argument("unknown option " + arg);
+		}
+		if (options.steps == 0 || options.step <= 0.0)
+			throw invalid_argument("--steps and --step must be positive");
+		return options;
+	}
+
+	//Like SMMesh::LoadMesh for the shadow caster only
+	ShadowCaster LoadCaster(const filesystem::path& path)
+	{
+		// kolejnosc scian, krawedzi i meshletow jak w aplikacji, ktora laduje ogniwa z optymalizacja
+		MeshData data = LoadBinaryMesh(path);
+		OptimizeVertexOrder(data);
+		ShadowCaster caster;
+		caster.positions = move(data.positions);
+		for (uint32_t p : data.vertexPositions)
+			caster.vertices.push_back(caster.positions[p]);
+		caster.faces = move(data.faces);
+		caster.edges = move(data.edges);
+		caster.PrepareMesh();
+		return caster;
+	}
+
+	//Shadow volumes of the arm links, in object space with the silhouette tracked between steps
+	class ArmShadows
+	{
+	public:
+		explicit ArmShadows(const filesystem::path& meshes)
+		{
+			for (size_t i = 0; i < PumaLinkCount; ++i)
+			{
+				m_casters[i] = LoadCaster(meshes / ("mesh" + to_string(i + 1) + BinaryMeshExtension));
+				m_volumes[i].temporalCoherence = true;
+			}
+		}
+
+		void Build(const XMFLOAT4X4 links[PumaLinkCount], double row[ColumnCount])
+		{
+			m_jobs.ParallelFor(PumaLinkCount, [&](size_t i)
+			{
+				m_casters[i].GenerateShadowVolume(m_volumes[i], LightPos, links[i], InfiniteExtrusion, VolumeSpace::Object);
+			});
+			double triangles = 0.0, silhouette = 0.0, tested = 0.0;
+			for (const ShadowVolume& volume : m_volumes)
+			{
+				triangles += volume.indices.size() / 3;
+				silhouette += volume.silhouette.size();
+				tested += volume.tracker.TestedFraction();
+			}
+			row[10] = triangles;
+			row[11] = silhouette;
+			row[12] = tested / PumaLinkCount;
+		}
+
+	private:
+		JobSystem m_jobs;
+		ShadowCaster m_casters[PumaLinkCount];
+		ShadowVolume m_volumes[PumaLinkCount];
+	};
+
+	class Output
+	{
+	public:
+		explicit Output(const Options& options)
+		{
+			if (!options.csv.empty())
+			{
+				m_csv = fopen(options.csv.string().c_str(), "w");
+				if (!m_csv)
+					throw runtime_error("cannot open " + options.csv.string());
+				for (size_t i = 0; i < ColumnCount; ++i)
+					fprintf(m_csv, i ? ",%s" : "%s", Columns[i]);
+				fputc('\n', m_csv);
+			}
+			if (!options.binary.empty())
+			{
+				m_binary.open(options.binary, ios::binary);
+				if (!m_binary)
+					throw runtime_error("cannot open " + options.binary.string());
+				const uint32_t header[] = { 2, static_cast<uint32_t>(ColumnCount) };
+				m_binary.write("PSIM", 4);
+				m_binary.write(reinterpret_cast<const char*>(header), sizeof(header));
+			}
+		}
+		Output(const Output&) = delete;
+		Output& operator=(const Output&) = delete;
+		~Output()
+		{
+			if (m_csv)
+				fclose(m_csv);
+		}
+
+		void Write(const double row[ColumnCount])
+		{
+			if (m_csv)
+			{
+				// %.9g - liczby float zapisane bez straty, pliki mozna porownywac miedzy przebiegami
+				for (size_t i = 0; i < ColumnCount; ++i)
+					fprintf(m_csv, i ? ",%.9g" : "%.9g", row[i]);
+				fputc('\n', m_csv);
+			}
+			if (m_binary.is_open())
+				m_binary.write(reinterpret_cast<const char*>(row), ColumnCount * sizeof(double));
+		}
+
+	private:
+		FILE* m_csv = nullptr;
+		ofstream m_binary;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		const Options options = ParseOptions(argc, argv);
+		PumaSimulation simulation(SceneMirrorMtx(), options.seed);
+		unique_ptr<ArmShadows> shadows;
+		if (options.shadows)
+			shadows = make_unique<ArmShadows>(options.meshes);
+		Output output(options);
+
+		chrono::steady_clock::duration simulationTime{}, shadowTime{};
+		const float dt = static_cast<float>(options.step);
+		for (uint64_t step = 0; step < options.steps; ++step)
+		{
+			auto start = chrono::steady_clock::now();
+			simulation.Step(dt);
+			auto simulated = chrono::steady_clock::now();
+			simulationTime += simulated - start;
+
+			double row[ColumnCount] = { static_cast<double>(step + 1), (step + 1) * options.step };
+			for (size_t j = 0; j < PumaJointCount; ++j)
+				row[2 + j] = simulation.Angles()[j];
+			row[7] = static_cast<double>(simulation.Particles().particlesCount());
+			row[8] = static_cast<double>(simulation.IkStats().solves);
+			row[9] = static_cast<double>(simulation.IkStats().iterations);
+			simulation.ResetIkStats();
+			if (shadows)
+			{
+				XMFLOAT4X4 links[PumaLinkCount];
+				simulation.LinkMatrices(1.f, links);
+				shadows->Build(links, row);
+				shadowTime += chrono::steady_clock::now() - simulated;
+			}
+			output.Write(row);
+		}
+
+		const double seconds = chrono::duration<double>(simulationTime + shadowTime).count();
+		printf("%llu steps of %g s in %.3f s: %.0f steps/s\n", static_cast<unsigned long long>(options.steps), options.step,
+			seconds, options.steps / seconds);
+		printf("  simulation %.2f us/step", 1e6 * chrono::duration<double>(simulationTime).count() / options.steps);
+		if (shadows)
+			printf(", shadow volumes %.2f us/step", 1e6 * chrono::duration<double>(shadowTime).count() / options.steps);
+		printf("\n");
+		return 0;
+	}
+	catch (const invalid_argument& e)
+	{
+		fprintf(stderr, "%s\nusage: %s [--steps N] [--step SECONDS] [--seed N] [--shadows] [--meshes DIR] "
+			"[--csv FILE] [--binary FILE]\n", e.what(), argv[0]);
+		return 2;
+	}
+	catch (const exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <exception>
+#include "meshAdjacency.h"
+#include "meshFile.h"
+
+//Converts text meshes to the binary mesh format (and back, for binary inputs):
+//puma_mesh_converter mesh1.txt [mesh2.txt ...]
+//writes mesh1.pmesh next to each input. Edges are rebuilt for text meshes
+//without edges and for indexed .mesh files (positions welded exactly).
+
+using namespace mini;
+using namespace std;
+
+namespace
+{
+	MeshData FromIndexedMesh(const IndexedMeshData& indexed)
+	{
+		MeshData mesh;
+		WeldedPositions welded = WeldPositions(indexed.positions);
+		mesh.positions = move(welded.positions);
+		mesh.vertexPositions = move(welded.vertexPositions);
+		mesh.normals = indexed.normals;
+		for (size_t i = 0; i + 2 < indexed.indices.size(); i += 3)
+			mesh.faces.emplace_back(indexed.indices[i], indexed.indices[i + 1], indexed.indices[i + 2]);
+		return mesh;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s mesh.txt|mesh.mesh|mesh%s...\n", argv[0], BinaryMeshExtension);
+		return 2;
+	}
+	int failed = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		filesystem::path input = argv[i], output = input;
+		try
+		{
+			if (input.extension() == BinaryMeshExtension)
+			{
+				output.replace_extension(".txt");
+				MappedFile file(input);
+				SaveTextMesh(ViewBinaryMesh(file), output);
+			}
+			else
+			{
+				output.replace_extension(BinaryMeshExtension);
+				MeshData mesh = input.extension() == ".mesh" ? FromIndexedMesh(LoadIndexedTextMesh(input)) : LoadTextMesh(input);
+				if (mesh.edges.empty())
+				{
+					// otwarte krawedzie zostaja w pliku, zamyka je dopiero ShadowCaster
+					AdjacencyStats stats;
+					mesh.edges = BuildEdges(mesh.faces, mesh.vertexPositions, &stats);
+					printf("%s: rebuilt edges, %zu open, %zu non-manifold\n", input.string().c_str(),
+						stats.boundaryEdges, stats.nonManifoldEdges);
+				}
+				SaveBinaryMesh(MeshView(mesh), output);
+				printf("%s: %zu positions, %zu vertices, %zu faces, %zu edges\n", output.string().c_str(),
+					mesh.positions.size(), mesh.vertexPositions.size(), mesh.faces.size(), mesh.edges.size());
+			}
+		}
+		catch (const exception& e)
+		{
+			fprintf(stderr, "%s: %s\n", input.string().c_str(), e.what());
+			++failed;
+		}
+	}
+	return failed ? 1 : 0;
+}